@@ -6883,6 +6883,40 @@ mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context *pContext, co
     return MZ_FALSE;
 }
 
+mz_bool mz_zip_writer_add_staged_data_deflated(mz_zip_writer_staged_context *pContext, const char *pRead_buf, size_t n, const char *pComp_buf, size_t comp_n)
+{
+    if (pContext->file_ofs + n > pContext->max_size)
+    {
+        mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_READ_FAILED);
+        pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+        pContext->pCompressor = NULL;
+        return MZ_FALSE;
+    }
+
+    /* Byte align the data compressed so far and forget its dictionary, so that the block deflated by the caller may follow. */
+    if (tdefl_compress_buffer(pContext->pCompressor, NULL, 0, TDEFL_FULL_FLUSH) != TDEFL_STATUS_OKAY)
+    {
+        mz_zip_set_error(pContext->pZip, MZ_ZIP_COMPRESSION_FAILED);
+        pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+        pContext->pCompressor = NULL;
+        return MZ_FALSE;
+    }
+
+    if (pContext->pZip->m_pWrite(pContext->pZip->m_pIO_opaque, pContext->add_state.m_cur_archive_file_ofs, pComp_buf, comp_n) != comp_n)
+    {
+        mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_WRITE_FAILED);
+        pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+        pContext->pCompressor = NULL;
+        return MZ_FALSE;
+    }
+
+    pContext->add_state.m_cur_archive_file_ofs += comp_n;
+    pContext->add_state.m_comp_size += comp_n;
+    pContext->file_ofs += n;
+    pContext->uncomp_crc32 = (mz_uint32)mz_crc32(pContext->uncomp_crc32, (const mz_uint8 *)pRead_buf, n);
+    return MZ_TRUE;
+}
+
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context *pContext)
 {
     if (! mz_zip_writer_add_staged_data(pContext, NULL, 0) ||
@@ -1352,6 +1352,9 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     mz_uint64 max_size, const MZ_TIME_T* pFile_time, const void* pComment, mz_uint16 comment_size, mz_uint level_and_flags,
     const char* user_extra_data, mz_uint user_extra_data_len, const char* user_extra_data_central, mz_uint user_extra_data_central_len);
 mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context* pContext, const char* pRead_buf, size_t n);
+/* Adds a block of data deflated by the caller, for example on another thread. pComp_buf must contain raw deflate data (no zlib header) */
+/* produced by a fresh tdefl_compressor and terminated by TDEFL_FULL_FLUSH, pRead_buf is the data before compression. */
+mz_bool mz_zip_writer_add_staged_data_deflated(mz_zip_writer_staged_context* pContext, const char* pRead_buf, size_t n, const char* pComp_buf, size_t comp_n);
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context* pContext);
 
 /* Adds a file to an archive by fully cloning the data from another archive. */
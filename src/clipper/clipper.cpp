@@ -767,15 +767,38 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
     return false;
 
   // Allocate a new edge array.
-  Edges edges(highI + 1);
+  TEdge *edges = AllocateEdges(highI + 1);
   // Fill in the edge array.
-  bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
-  if (result)
-    // Success, remember the edge array.
-    m_edges.emplace_back(std::move(edges));
+  bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges);
+  if (! result)
+    // Failure, return the edge array.
+    FreeLastEdges(highI + 1);
   return result;
 }
 
+TEdge* ClipperBase::AllocateEdges(size_t num_edges)
+{
+  // Find a block with enough space left, starting with the current one.
+  for (; m_edges_block < m_edges.size(); ++ m_edges_block, m_edges_used = 0) {
+    Edges &edges = m_edges[m_edges_block];
+    if (m_edges_used + num_edges <= edges.capacity()) {
+      TEdge *out = edges.data() + m_edges_used;
+      m_edges_used += num_edges;
+      if (edges.size() < m_edges_used)
+        // Initialize the edges allocated from this block for the first time. Resizing within the capacity does not reallocate.
+        edges.resize(m_edges_used);
+      return out;
+    }
+  }
+  // Allocate a new block, at least twice the size of the last one.
+  m_edges.emplace_back();
+  m_edges.back().reserve(std::max(num_edges, m_edges.size() == 1 ? 0 : 2 * m_edges[m_edges.size() - 2].capacity()));
+  m_edges.back().resize(num_edges);
+  m_edges_block = m_edges.size() - 1;
+  m_edges_used  = num_edges;
+  return m_edges.back().data();
+}
+
 bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
 {
 #ifdef use_lines
@@ -959,7 +982,12 @@ bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, b
 void ClipperBase::Clear()
 {
   m_MinimaList.clear();
-  m_edges.clear();
+  // Retain the first blocks of edges for the next use.
+  size_t num_retained = 0;
+  m_edges.erase(std::find_if(m_edges.begin(), m_edges.end(),
+    [&num_retained](const Edges &edges) { return (num_retained += edges.capacity()) > m_MaxRetainedEdges; }), m_edges.end());
+  m_edges_block = 0;
+  m_edges_used  = 0;
 #ifndef CLIPPERLIB_INT32
   m_UseFullRange = false;
 #endif // CLIPPERLIB_INT32
@@ -1041,6 +1069,7 @@ IntRect ClipperBase::GetBounds()
 
 Clipper::Clipper(int initOptions) : 
   ClipperBase(),
+  m_OutPtsChunksUsed(0),
   m_OutPtsFree(nullptr),
   m_OutPtsChunkLast(m_OutPtsChunkSize),
   m_ActiveEdges(nullptr),
@@ -1059,7 +1088,7 @@ Clipper::Clipper(int initOptions) :
 void Clipper::Reset()
 {
   ClipperBase::Reset();
-  m_Scanbeam = std::priority_queue<cInt, cInts>{};
+  m_Scanbeam.clear();
   m_Maxima.clear();
   m_ActiveEdges = 0;
   m_SortedEdges = 0;
@@ -1174,19 +1203,22 @@ OutPt* Clipper::AllocateOutPt()
     m_OutPtsFree = pt->Next;
   } else if (m_OutPtsChunkLast < m_OutPtsChunkSize) {
     // Get a point from the last chunk.
-    pt = &m_OutPts.back()[m_OutPtsChunkLast ++];
+    pt = &m_OutPts[m_OutPtsChunksUsed - 1][m_OutPtsChunkLast ++];
   } else {
-    // The last chunk is full. Allocate a new one.
-    m_OutPts.emplace_back();
+    // The last chunk is full. Reuse a retained chunk or allocate a new one.
+    if (m_OutPtsChunksUsed == m_OutPts.size())
+      m_OutPts.emplace_back();
     m_OutPtsChunkLast = 1;
-    pt = &m_OutPts.back().front();
+    pt = &m_OutPts[m_OutPtsChunksUsed ++].front();
   }
   return pt;
 }
 
 void Clipper::DisposeAllOutRecs()
 {
-  m_OutPts.clear();
+  if (m_OutPts.size() > m_OutPtsMaxRetainedChunks)
+    m_OutPts.resize(m_OutPtsMaxRetainedChunks);
+  m_OutPtsChunksUsed = 0;
   m_OutPtsFree = nullptr;
   m_OutPtsChunkLast = m_OutPtsChunkSize;
   m_PolyOuts.clear();
@@ -3359,20 +3391,42 @@ DoublePoint GetUnitNormal(const IntPoint &pt1, const IntPoint &pt2)
 // ClipperOffset class
 //------------------------------------------------------------------------------
 
+ClipperOffset::~ClipperOffset()
+{
+  for (PolyNode *node : m_polyNodes.Childs)
+    delete node;
+  for (PolyNode *node : m_polyNodesFree)
+    delete node;
+}
+//------------------------------------------------------------------------------
+
 void ClipperOffset::Clear()
 {
-  for (int i = 0; i < m_polyNodes.ChildCount(); ++i)
-    delete m_polyNodes.Childs[i];
+  // Keep the nodes for the paths added later.
+  for (PolyNode *node : m_polyNodes.Childs) {
+    node->Contour.clear();
+    m_polyNodesFree.emplace_back(node);
+  }
   m_polyNodes.Childs.clear();
   m_lowest.x() = -1;
 }
 //------------------------------------------------------------------------------
 
+PolyNode* ClipperOffset::AllocatePolyNode()
+{
+  if (m_polyNodesFree.empty())
+    return new PolyNode();
+  PolyNode *node = m_polyNodesFree.back();
+  m_polyNodesFree.pop_back();
+  return node;
+}
+//------------------------------------------------------------------------------
+
 void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType)
 {
   int highI = (int)path.size() - 1;
   if (highI < 0) return;
-  PolyNode* newNode = new PolyNode();
+  PolyNode* newNode = AllocatePolyNode();
   newNode->m_jointype = joinType;
   newNode->m_endtype = endType;
 
@@ -3412,7 +3466,8 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
   }
   if (endType == etClosedPolygon && j < 2)
   {
-    delete newNode;
+    newNode->Contour.clear();
+    m_polyNodesFree.emplace_back(newNode);
     return;
   }
   m_polyNodes.AddChild(*newNode);
@@ -3465,7 +3520,9 @@ void ClipperOffset::Execute(Paths& solution, double delta)
   DoOffset(delta);
   
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -3496,7 +3553,9 @@ void ClipperOffset::Execute(PolyTree& solution, double delta)
   DoOffset(delta);
 
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -358,10 +358,10 @@ public:
       return false;
 
     // Allocate a new edge array.
-    std::vector<TEdge, Allocator<TEdge>> edges(num_edges_total);
+    TEdge *edges = AllocateEdges(num_edges_total);
     // Fill in the edge array.
     bool result = false;
-    TEdge *p_edge = edges.data();
+    TEdge *p_edge = edges;
     i = 0;
     for (const Path &pg : paths_provider) {
       if (num_edges[i]) {
@@ -373,9 +373,8 @@ public:
       }
       ++ i;
     }
-    if (result)
-      // At least some edges were generated. Remember the edge array.
-      m_edges.emplace_back(std::move(edges));
+    // Return the edges not used by the paths, which failed to produce any edge.
+    FreeLastEdges(num_edges_total - (p_edge - edges));
     return result;
   }
 
@@ -387,6 +386,9 @@ public:
   void PreserveCollinear(bool value) {m_PreserveCollinear = value;};
 protected:
   bool AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
+  // Allocate a continuous array of edges from m_edges, free the last allocated edges if unused.
+  TEdge* AllocateEdges(size_t num_edges);
+  void FreeLastEdges(size_t num_edges) { m_edges_used -= num_edges; }
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
   void Reset();
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
@@ -404,9 +406,16 @@ protected:
   bool              m_UseFullRange;
 #endif // CLIPPERLIB_INT32
 
-  // A vector of edges per each input path.
+  // Edges of the input paths, allocated from blocks of growing size.
+  // The blocks are retained by Clear() up to m_MaxRetainedEdges, thus a Clipper reused for a sequence of operations
+  // does not allocate the edges over and over.
+  // The blocks are reserved, but their edges are only initialized when allocated for the first time.
   using Edges = std::vector<TEdge, Allocator<TEdge>>;
   std::vector<Edges, Allocator<Edges>> m_edges;
+  // Block of m_edges to allocate the edges from and the number of edges of that block already allocated.
+  size_t           m_edges_block { 0 };
+  size_t           m_edges_used  { 0 };
+  static constexpr const size_t m_MaxRetainedEdges = 65536;
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -452,8 +461,12 @@ private:
   // Output polygons.
   std::deque<OutRec, Allocator<OutRec>>  m_PolyOuts;
   // Output points, allocated by a continuous sets of m_OutPtsChunkSize.
+  // Up to m_OutPtsMaxRetainedChunks chunks are retained by DisposeAllOutRecs() for the next Execute().
   static constexpr const size_t m_OutPtsChunkSize = 32;
+  static constexpr const size_t m_OutPtsMaxRetainedChunks = 1024;
   std::deque<std::array<OutPt, m_OutPtsChunkSize>, Allocator<std::array<OutPt, m_OutPtsChunkSize>>> m_OutPts;
+  // Number of chunks of m_OutPts in use, the last of them is filled up to m_OutPtsChunkLast.
+  size_t                m_OutPtsChunksUsed;
   // List of free output points, to be used before taking a point from m_OutPts or allocating a new chunk.
   OutPt                *m_OutPtsFree;
   size_t                m_OutPtsChunkLast;
@@ -464,7 +477,11 @@ private:
   ClipType              m_ClipType;
   // A priority queue (a binary heap) of Y coordinates.
   using cInts = std::vector<cInt, Allocator<cInt>>;
-  std::priority_queue<cInt, cInts> m_Scanbeam;
+  // Unlike assigning an empty std::priority_queue, clear() keeps the memory of the heap.
+  struct Scanbeam : public std::priority_queue<cInt, cInts> {
+    void clear() { this->c.clear(); }
+  };
+  Scanbeam              m_Scanbeam;
   // Maxima are collected by ProcessEdgesAtTopOfScanbeam(), consumed by ProcessHorizontal().
   cInts                 m_Maxima;
   TEdge                *m_ActiveEdges;
@@ -540,7 +557,7 @@ class ClipperOffset
 public:
   ClipperOffset(double miterLimit = 2.0, double roundPrecision = 0.25, double shortestEdgeLength = 0.) :
     MiterLimit(miterLimit), ArcTolerance(roundPrecision), ShortestEdgeLength(shortestEdgeLength), m_lowest(-1, 0) {}
-  ~ClipperOffset() { Clear(); }
+  ~ClipperOffset();
   void AddPath(const Path& path, JoinType joinType, EndType endType);
   template<typename PathsProvider>
   void AddPaths(PathsProvider &&paths, JoinType joinType, EndType endType) {
@@ -565,6 +582,12 @@ private:
   // y: index of the lowest point in the lowest contour
   IntPoint m_lowest;
   PolyNode m_polyNodes;
+  // Nodes released by Clear(), recycled by AddPath() together with the memory of their contours.
+  PolyNodes m_polyNodesFree;
+  // Clipper to clean up the offsetted polygons, reused by the subsequent calls to Execute().
+  Clipper m_clipper;
+
+  PolyNode* AllocatePolyNode();
 
   void FixOrientations();
   void DoOffset(double delta);
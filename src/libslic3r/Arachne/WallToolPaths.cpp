@@ -8,6 +8,8 @@
 #include <cinttypes>
 #include <cmath>
 
+#include <boost/functional/hash.hpp>
+
 #include "WallToolPaths.hpp"
 #include "SkeletalTrapezoidation.hpp"
 #include "utils/linearAlg2D.hpp"
@@ -766,4 +768,77 @@ bool WallToolPaths::removeEmptyToolPaths(std::vector<VariableWidthLines> &toolpa
     return toolpaths.empty();
 }
 
+bool WallToolPathsCache::Parameters::operator==(const Parameters &rhs) const
+{
+    return bead_width_0 == rhs.bead_width_0 && bead_width_x == rhs.bead_width_x && inset_count == rhs.inset_count && wall_0_inset == rhs.wall_0_inset &&
+           layer_height == rhs.layer_height && min_feature_size == rhs.min_feature_size && min_bead_width == rhs.min_bead_width &&
+           wall_transition_filter_deviation == rhs.wall_transition_filter_deviation && wall_transition_length == rhs.wall_transition_length &&
+           wall_transition_angle == rhs.wall_transition_angle && wall_distribution_count == rhs.wall_distribution_count;
+}
+
+WallToolPathsCache::ResultPtr WallToolPathsCache::generate(const Polygons &outline, const coord_t bead_width_0, const coord_t bead_width_x,
+                                                           const size_t inset_count, const coord_t wall_0_inset, const coordf_t layer_height,
+                                                           const PrintObjectConfig &print_object_config, const PrintConfig &print_config)
+{
+    // Constructing WallToolPaths is cheap, it just resolves its parameters.
+    WallToolPaths    wall_tool_paths(outline, bead_width_0, bead_width_x, inset_count, wall_0_inset, layer_height, print_object_config, print_config);
+    const Parameters parameters { bead_width_0, bead_width_x, inset_count, wall_0_inset, layer_height,
+                                  wall_tool_paths.min_feature_size, wall_tool_paths.min_bead_width,
+                                  wall_tool_paths.wall_transition_filter_deviation, wall_tool_paths.wall_transition_length,
+                                  print_object_config.wall_transition_angle.value, print_object_config.wall_distribution_count.value };
+
+    size_t hash       = 0;
+    size_t num_points = 0;
+    for (const Polygon &polygon : outline) {
+        boost::hash_combine(hash, polygon.size());
+        for (const Point &pt : polygon.points) {
+            boost::hash_combine(hash, pt.x());
+            boost::hash_combine(hash, pt.y());
+        }
+        num_points += polygon.size();
+    }
+    boost::hash_combine(hash, bead_width_0);
+    boost::hash_combine(hash, inset_count);
+
+    // To be called with m_mutex locked.
+    auto find_cached = [this, hash, &parameters, &outline]() -> ResultPtr {
+        for (auto [it, it_end] = m_entries.equal_range(hash); it != it_end; ++ it)
+            if (it->second.parameters == parameters && it->second.outline == outline)
+                return it->second.result;
+        return {};
+    };
+
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        if (ResultPtr cached = find_cached(); cached)
+            return cached;
+    }
+
+    // Generate outside of the lock. If another thread generates toolpaths for the same outline in the meantime, the first one is kept.
+    auto result = std::make_shared<Result>();
+    result->toolpaths     = wall_tool_paths.getToolPaths();
+    result->inner_contour = wall_tool_paths.getInnerContour();
+
+    for (const VariableWidthLines &lines : result->toolpaths)
+        for (const ExtrusionLine &line : lines)
+            num_points += line.size();
+    num_points += count_points(result->inner_contour);
+
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    if (ResultPtr cached = find_cached(); cached)
+        return cached;
+    if (m_num_points + num_points <= MaxPoints) {
+        m_entries.insert({ hash, Entry{ outline, parameters, result } });
+        m_num_points += num_points;
+    }
+    return result;
+}
+
+void WallToolPathsCache::clear()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_num_points = 0;
+}
+
 } // namespace Slic3r::Arachne
@@ -7,6 +7,8 @@
 #include <ankerl/unordered_dense.h>
 #include <stddef.h>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <cstddef>
@@ -124,6 +126,60 @@ private:
     std::vector<VariableWidthLines> toolpaths; //<! The generated toolpaths
     Polygons inner_contour;  //<! The inner contour of the generated toolpaths
     const PrintObjectConfig &print_object_config;
+
+    friend class WallToolPathsCache;
+};
+
+// Toolpaths and inner contours generated by WallToolPaths, shared between layers and objects with exactly the same outlines
+// and the same parameters. Prismatic objects produce many layers with identical slices, for which the Voronoi diagram
+// and the skeletal trapezoidation would be calculated again and again.
+// The outlines are matched exactly, not up to a translation, so that the result does not depend on which layer was processed first.
+// Thread safe.
+class WallToolPathsCache
+{
+public:
+    struct Result {
+        std::vector<VariableWidthLines> toolpaths;
+        Polygons                        inner_contour;
+    };
+    using ResultPtr = std::shared_ptr<const Result>;
+
+    // The same parameters as of the WallToolPaths constructor.
+    // Returns the toolpaths and the inner contour of a previous call with the same parameters, otherwise generates them.
+    ResultPtr generate(const Polygons &outline, coord_t bead_width_0, coord_t bead_width_x, size_t inset_count, coord_t wall_0_inset, coordf_t layer_height, const PrintObjectConfig &print_object_config, const PrintConfig &print_config);
+
+    void      clear();
+
+private:
+    // Parameters of WallToolPaths after resolving the percent values of the configuration.
+    struct Parameters {
+        coord_t  bead_width_0;
+        coord_t  bead_width_x;
+        size_t   inset_count;
+        coord_t  wall_0_inset;
+        coordf_t layer_height;
+        coord_t  min_feature_size;
+        coord_t  min_bead_width;
+        coord_t  wall_transition_filter_deviation;
+        coord_t  wall_transition_length;
+        double   wall_transition_angle;
+        int      wall_distribution_count;
+
+        bool operator==(const Parameters &rhs) const;
+    };
+
+    struct Entry {
+        Polygons   outline;
+        Parameters parameters;
+        ResultPtr  result;
+    };
+
+    // Don't keep more than this number of points of the outlines and the toolpaths, non-prismatic objects would just fill the cache.
+    static constexpr size_t MaxPoints = 4 * 1024 * 1024;
+
+    std::mutex                              m_mutex;
+    std::unordered_multimap<size_t, Entry>  m_entries;
+    size_t                                  m_num_points = 0;
 };
 
 } // namespace Slic3r::Arachne
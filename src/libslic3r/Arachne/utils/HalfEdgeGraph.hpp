@@ -6,7 +6,12 @@
 
 
 #include <list>
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 
 
@@ -15,14 +20,125 @@
 
 namespace Slic3r::Arachne
 {
+
+// Memory for the nodes and edges of a single HalfEdgeGraph.
+// Nodes and edges are allocated from blocks of growing size, which are released all at once together with the graph.
+// Nodes and edges removed from the graph are recycled for the nodes and edges added later.
+// A graph is built for each and every island of each and every layer, thus allocating its nodes and edges one by one
+// from the global heap is costly and it scatters them over the memory.
+class HalfEdgeGraphArena
+{
+public:
+    HalfEdgeGraphArena() = default;
+    HalfEdgeGraphArena(const HalfEdgeGraphArena &) = delete;
+    HalfEdgeGraphArena& operator=(const HalfEdgeGraphArena &) = delete;
+
+    void* allocate(size_t size, size_t alignment)
+    {
+        assert(size >= sizeof(void*));
+        assert(alignment <= alignof(std::max_align_t));
+        for (FreeList &free_list : m_free_lists)
+            if (free_list.size == size) {
+                if (void *ptr = free_list.head; ptr != nullptr) {
+                    free_list.head = *static_cast<void**>(ptr);
+                    return ptr;
+                }
+                break;
+            }
+        size_t offset = (m_block_used + alignment - 1) & ~(alignment - 1);
+        if (m_blocks.empty() || offset + size > m_block_size) {
+            m_block_size = std::max(m_blocks.empty() ? InitialBlockSize : std::min(2 * m_block_size, MaxBlockSize), size);
+            m_blocks.emplace_back(new std::byte[m_block_size]);
+            offset = 0;
+        }
+        m_block_used = offset + size;
+        return m_blocks.back().get() + offset;
+    }
+
+    void deallocate(void *ptr, size_t size)
+    {
+        auto it = std::find_if(m_free_lists.begin(), m_free_lists.end(), [size](const FreeList &free_list) { return free_list.size == size; });
+        if (it == m_free_lists.end())
+            it = m_free_lists.insert(it, { size, nullptr });
+        *static_cast<void**>(ptr) = it->head;
+        it->head = ptr;
+    }
+
+private:
+    static constexpr size_t InitialBlockSize = 16384;
+    static constexpr size_t MaxBlockSize     = 1024 * 1024;
+
+    // Singly linked list of released memory chunks of the same size, the link is stored in the chunk itself.
+    struct FreeList {
+        size_t  size;
+        void   *head;
+    };
+
+    std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+    size_t                                    m_block_size = 0;
+    size_t                                    m_block_used = 0;
+    // Usually there are just two of them: One for the list nodes holding the graph nodes, one for the graph edges.
+    std::vector<FreeList>                     m_free_lists;
+};
+
+// Allocator of the list nodes holding the nodes and edges of a HalfEdgeGraph from its HalfEdgeGraphArena.
+template<typename T>
+class HalfEdgeGraphAllocator
+{
+public:
+    using value_type                             = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    explicit HalfEdgeGraphAllocator(HalfEdgeGraphArena &arena) noexcept : m_arena(&arena) {}
+    template<typename U>
+    HalfEdgeGraphAllocator(const HalfEdgeGraphAllocator<U> &rhs) noexcept : m_arena(rhs.m_arena) {}
+
+    T* allocate(size_t n)
+    {
+        // std::list allocates its nodes one by one.
+        return n == 1 ? static_cast<T*>(m_arena->allocate(sizeof(T), alignof(T))) : std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept
+    {
+        if (n == 1)
+            m_arena->deallocate(ptr, sizeof(T));
+        else
+            std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template<typename U>
+    bool operator==(const HalfEdgeGraphAllocator<U> &rhs) const noexcept { return m_arena == rhs.m_arena; }
+    template<typename U>
+    bool operator!=(const HalfEdgeGraphAllocator<U> &rhs) const noexcept { return m_arena != rhs.m_arena; }
+
+private:
+    template<typename U> friend class HalfEdgeGraphAllocator;
+
+    HalfEdgeGraphArena *m_arena;
+};
+
 template<class node_data_t, class edge_data_t, class derived_node_t, class derived_edge_t> // types of data contained in nodes and edges
 class HalfEdgeGraph
 {
 public:
     using edge_t = derived_edge_t;
     using node_t = derived_node_t;
-    using Edges = std::list<edge_t>;
-    using Nodes = std::list<node_t>;
+    using Edges = std::list<edge_t, HalfEdgeGraphAllocator<edge_t>>;
+    using Nodes = std::list<node_t, HalfEdgeGraphAllocator<node_t>>;
+
+    HalfEdgeGraph() : edges(HalfEdgeGraphAllocator<edge_t>(m_arena)), nodes(HalfEdgeGraphAllocator<node_t>(m_arena)) {}
+    // The nodes and edges point to each other, the graph could not be copied by copying the lists anyway.
+    HalfEdgeGraph(const HalfEdgeGraph &) = delete;
+    HalfEdgeGraph& operator=(const HalfEdgeGraph &) = delete;
+
+private:
+    // Declared before the edges and nodes, so that it outlives them.
+    HalfEdgeGraphArena m_arena;
+
+public:
     Edges edges;
     Nodes nodes;
 };
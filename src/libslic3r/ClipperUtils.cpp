@@ -12,6 +12,8 @@
 #include "ClipperUtils.hpp"
 
 #include <cmath>
+#include <optional>
+#include <type_traits>
 
 #include "ShortestPath.hpp"
 #include "libslic3r/BoundingBox.hpp"
@@ -203,6 +205,110 @@ namespace ClipperUtils {
         out.erase(std::remove_if(out.begin(), out.end(), [](const Polygon &polygon) {return polygon.empty(); }), out.end());
         return out;
     }
+
+    thread_local ClipperContext *ClipperContext::s_current = nullptr;
+
+    std::unique_ptr<ClipperLib::Clipper> ClipperContext::acquire_clipper()
+    {
+        if (m_clippers.empty())
+            return std::make_unique<ClipperLib::Clipper>();
+        std::unique_ptr<ClipperLib::Clipper> out = std::move(m_clippers.back());
+        m_clippers.pop_back();
+        return out;
+    }
+
+    void ClipperContext::release(std::unique_ptr<ClipperLib::Clipper> &&clipper)
+    {
+        // Keeps the memory of the edges, output points etc.
+        clipper->Clear();
+        clipper->ReverseSolution(false);
+        clipper->StrictlySimple(false);
+        clipper->PreserveCollinear(false);
+        m_clippers.emplace_back(std::move(clipper));
+    }
+
+    std::unique_ptr<ClipperLib::ClipperOffset> ClipperContext::acquire_offset()
+    {
+        if (m_offsets.empty())
+            return std::make_unique<ClipperLib::ClipperOffset>();
+        std::unique_ptr<ClipperLib::ClipperOffset> out = std::move(m_offsets.back());
+        m_offsets.pop_back();
+        return out;
+    }
+
+    void ClipperContext::release(std::unique_ptr<ClipperLib::ClipperOffset> &&offset)
+    {
+        // Keeps the nodes of the source paths and the Clipper cleaning up the offsetted paths.
+        offset->Clear();
+        // Defaults of the ClipperOffset constructor.
+        offset->MiterLimit         = 2.;
+        offset->ArcTolerance       = 0.25;
+        offset->ShortestEdgeLength = 0.;
+        m_offsets.emplace_back(std::move(offset));
+    }
+
+    ClipperLib::PolyTree ClipperContext::acquire_polytree()
+    {
+        if (m_polytrees.empty())
+            return ClipperLib::PolyTree();
+        ClipperLib::PolyTree out(std::move(m_polytrees.back()));
+        m_polytrees.pop_back();
+        return out;
+    }
+
+    void ClipperContext::release(ClipperLib::PolyTree &&polytree)
+    {
+        // Usually a single polygon tree is in flight, retain a few of them.
+        if (m_polytrees.size() < 4) {
+            polytree.Clear();
+            m_polytrees.emplace_back(std::move(polytree));
+        }
+    }
+
+    // ClipperLib engine for a single operation: Taken from the ClipperContext of the calling thread if there is any,
+    // otherwise constructed on the stack.
+    template<typename Engine>
+    class EngineLease {
+    public:
+        EngineLease() : m_context(ClipperContext::current()) {
+            if (m_context == nullptr)
+                m_local.emplace();
+            else if constexpr (std::is_same_v<Engine, ClipperLib::Clipper>)
+                m_leased = m_context->acquire_clipper();
+            else
+                m_leased = m_context->acquire_offset();
+        }
+        ~EngineLease() { if (m_leased) m_context->release(std::move(m_leased)); }
+        EngineLease(const EngineLease &) = delete;
+        EngineLease& operator=(const EngineLease &) = delete;
+
+        Engine& operator*()  { return m_leased ? *m_leased : *m_local; }
+        Engine* operator->() { return &**this; }
+
+    private:
+        ClipperContext          *m_context;
+        std::unique_ptr<Engine>  m_leased;
+        std::optional<Engine>    m_local;
+    };
+    using ClipperLease       = EngineLease<ClipperLib::Clipper>;
+    using ClipperOffsetLease = EngineLease<ClipperLib::ClipperOffset>;
+
+    // Empty result of a Clipper operation. A PolyTree is taken from the ClipperContext of the calling thread if there is any.
+    template<typename TResult>
+    inline TResult make_result() { return TResult(); }
+    template<>
+    inline ClipperLib::PolyTree make_result<ClipperLib::PolyTree>()
+    {
+        ClipperContext *context = ClipperContext::current();
+        return context ? context->acquire_polytree() : ClipperLib::PolyTree();
+    }
+
+    // Return a PolyTree, which contours were consumed, to the ClipperContext of the calling thread if there is any.
+    inline void recycle(ClipperLib::PolyTree &&polytree)
+    {
+        if (ClipperContext *context = ClipperContext::current(); context)
+            context->release(std::move(polytree));
+    }
 }
 
 static ExPolygons PolyTreeToExPolygons(ClipperLib::PolyTree &&polytree)
@@ -240,6 +346,7 @@ static ExPolygons PolyTreeToExPolygons(ClipperLib::PolyTree &&polytree)
     retval.reserve(cnt);
     for (int i = 0; i < polytree.ChildCount(); ++ i)
         Inner::PolyTreeToExPolygonsRecursive(std::move(*polytree.Childs[i]), &retval);
+    ClipperUtils::recycle(std::move(polytree));
     return retval;
 }
 
@@ -258,6 +365,7 @@ Polylines PolyTreeToPolylines(ClipperLib::PolyTree &&polytree)
     Polylines out;
     out.reserve(polytree.Total());
     Inner::AddPolyNodeToPaths(polytree, out);
+    ClipperUtils::recycle(std::move(polytree));
     return out;
 }
 
@@ -307,7 +415,8 @@ static ClipperLib::Paths raw_offset(PathsProvider &&paths, float offset, Clipper
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
 
-    ClipperLib::ClipperOffset co;
+    ClipperUtils::ClipperOffsetLease lease;
+    ClipperLib::ClipperOffset &co = *lease;
     ClipperLib::Paths out;
     out.reserve(paths.size());
     ClipperLib::Paths out_this;
@@ -350,11 +459,11 @@ TResult clipper_do(
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
 
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
-    clipper.AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
-    TResult retval;
-    clipper.Execute(clipType, retval, fillType, fillType);
+    ClipperUtils::ClipperLease clipper;
+    clipper->AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
+    clipper->AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
+    TResult retval = ClipperUtils::make_result<TResult>();
+    clipper->Execute(clipType, retval, fillType, fillType);
     return retval;
 }
 
@@ -381,10 +490,10 @@ TResult clipper_union(
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
 
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
-    TResult retval;
-    clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
+    ClipperUtils::ClipperLease clipper;
+    clipper->AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
+    TResult retval = ClipperUtils::make_result<TResult>();
+    clipper->Execute(ClipperLib::ctUnion, retval, fillType, fillType);
     return retval;
 }
 
@@ -422,14 +531,14 @@ static TResult shrink_paths(PathsProvider &&paths, float offset, ClipperLib::Joi
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
 
     assert(offset > 0);
-    TResult out;
+    TResult out = ClipperUtils::make_result<TResult>();
     if (auto raw = raw_offset(std::forward<PathsProvider>(paths), - offset, joinType, miterLimit); ! raw.empty()) {
-        ClipperLib::Clipper clipper;
-        clipper.AddPaths(raw, ClipperLib::ptSubject, true);
-        ClipperLib::IntRect r = clipper.GetBounds();
-        clipper.AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
-        clipper.ReverseSolution(true);
-        clipper.Execute(ClipperLib::ctUnion, out, ClipperLib::pftNegative, ClipperLib::pftNegative);
+        ClipperUtils::ClipperLease clipper;
+        clipper->AddPaths(raw, ClipperLib::ptSubject, true);
+        ClipperLib::IntRect r = clipper->GetBounds();
+        clipper->AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
+        clipper->ReverseSolution(true);
+        clipper->Execute(ClipperLib::ctUnion, out, ClipperLib::pftNegative, ClipperLib::pftNegative);
         remove_outermost_polygon(out);
     }
     return out;
@@ -471,16 +580,14 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
 
     // 1) Offset the outer contour.
     ClipperLib::Paths contours;
-    {
-        ClipperLib::ClipperOffset co;
-        if (joinType == jtRound)
-            co.ArcTolerance = miterLimit;
-        else
-            co.MiterLimit = miterLimit;
-        co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
-        co.AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
-        co.Execute(contours, delta);
-    }
+    ClipperUtils::ClipperOffsetLease co;
+    if (joinType == jtRound)
+        co->ArcTolerance = miterLimit;
+    else
+        co->MiterLimit = miterLimit;
+    co->ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
+    co->AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
+    co->Execute(contours, delta);
     if (contours.empty())
         // No need to try to offset the holes.
         return 0;
@@ -493,18 +600,14 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
         ClipperLib::Paths holes;
         {
             for (const Polygon &hole : expoly.holes) {
-                ClipperLib::ClipperOffset co;
-                if (joinType == jtRound)
-                    co.ArcTolerance = miterLimit;
-                else
-                    co.MiterLimit = miterLimit;
-                co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
-                co.AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
+                // Same offset parameters as for the outer contour.
+                co->Clear();
+                co->AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
                 ClipperLib::Paths out2;
                 // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
                 // contours will be CCW oriented even though the input paths are CW oriented.
                 // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-                co.Execute(out2, - delta);
+                co->Execute(out2, - delta);
                 append(holes, std::move(out2));
             }
         }
@@ -829,11 +932,11 @@ Polylines _clipper_pl_open(ClipperLib::ClipType clipType, PathsProvider1 &&subje
 {
     CLIPPER_UTILS_TIME_LIMIT_MILLIS(CLIPPER_UTILS_TIME_LIMIT_DEFAULT);
 
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
-    clipper.AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
-    ClipperLib::PolyTree retval;
-    clipper.Execute(clipType, retval, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    ClipperUtils::ClipperLease clipper;
+    clipper->AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
+    clipper->AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
+    ClipperLib::PolyTree retval = ClipperUtils::make_result<ClipperLib::PolyTree>();
+    clipper->Execute(clipType, retval, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     return PolyTreeToPolylines(std::move(retval));
 }
 
@@ -11,6 +11,7 @@
 #include <assert.h>
 #include <cstddef>
 #include <iterator>
+#include <memory>
 #include <utility>
 #include <vector>
 #include <cassert>
@@ -349,6 +350,43 @@ namespace ClipperUtils {
     [[nodiscard]] Polygons  clip_clipper_polygons_with_subject_bbox(const Polygons &src, const BoundingBox &bbox);
     [[nodiscard]] Polygons  clip_clipper_polygons_with_subject_bbox(const ExPolygon &src, const BoundingBox &bbox);
     [[nodiscard]] Polygons  clip_clipper_polygons_with_subject_bbox(const ExPolygons &src, const BoundingBox &bbox);
+
+    // Opt-in reuse of the ClipperLib engines by the functions of this module called from the current thread.
+    // While a ClipperContext is alive, the offset(), diff(), union_() ... functions take their ClipperLib::Clipper,
+    // ClipperLib::ClipperOffset and ClipperLib::PolyTree objects from it instead of constructing new ones, thus the memory
+    // of the input edges, of the output points, of the scan beam etc. is reused by the subsequent calls.
+    // This pays off for long sequences of small operations, for example when processing a layer after layer
+    // inside tbb::parallel_for(). Create the context on the stack of the worker thread for the duration of such a batch
+    // of work. The context is bound to the thread creating it, the innermost one of nested contexts is used.
+    class ClipperContext {
+    public:
+        ClipperContext() : m_previous(s_current) { s_current = this; }
+        ~ClipperContext() { assert(s_current == this); s_current = m_previous; }
+        ClipperContext(const ClipperContext &) = delete;
+        ClipperContext& operator=(const ClipperContext &) = delete;
+
+        // Context of the calling thread, nullptr if there is none.
+        static ClipperContext* current() { return s_current; }
+
+        // Engines are returned to the context cleared and with their options set to the defaults.
+        std::unique_ptr<ClipperLib::Clipper>        acquire_clipper();
+        void                                        release(std::unique_ptr<ClipperLib::Clipper> &&clipper);
+        std::unique_ptr<ClipperLib::ClipperOffset>  acquire_offset();
+        void                                        release(std::unique_ptr<ClipperLib::ClipperOffset> &&offset);
+        // Polygon trees keep the memory of their list of nodes.
+        ClipperLib::PolyTree                        acquire_polytree();
+        void                                        release(ClipperLib::PolyTree &&polytree);
+
+    private:
+        // Stacks of idle engines. More than one engine of a kind is in use for nested operations,
+        // for example when offsetting the clipping polygons of a difference.
+        std::vector<std::unique_ptr<ClipperLib::Clipper>>       m_clippers;
+        std::vector<std::unique_ptr<ClipperLib::ClipperOffset>> m_offsets;
+        std::vector<ClipperLib::PolyTree>                       m_polytrees;
+        ClipperContext                                         *m_previous;
+
+        static thread_local ClipperContext                     *s_current;
+    };
 }
 
 // offset Polygons
@@ -7,15 +7,18 @@
 #include <boost/geometry/core/access.hpp>
 #include <boost/geometry/core/static_assert.hpp>
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
 #include <algorithm>
 #include <numeric>
 #include <array>
+#include <atomic>
 #include <iterator>
 #include <limits>
 #include <optional>
 #include <cassert>
 #include <complex>
+#include <unordered_map>
 
 #include "../ClipperUtils.hpp"
 #include "../ExPolygon.hpp"
@@ -32,6 +35,11 @@
 #include "libslic3r/PrintConfig.hpp"
 #include "tcbspan/span.hpp"
 
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/enumerable_thread_specific.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <boost/functional/hash.hpp>
+
 // Boost pool: Don't use mutexes to synchronize memory allocation.
 #define BOOST_POOL_NO_MT
 #include <boost/pool/object_pool.hpp>
@@ -269,17 +277,31 @@ struct CubeProperties
 
 struct Octree
 {
-    // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
-    // perfect for building up our octree.
-    boost::object_pool<Cube>    pool;
+    // Octree will allocate its Cubes from the pools. The pool only supports deletion of the complete pool,
+    // perfect for building up our octree. The octree is built in parallel, thus there is a pool per thread.
+    tbb::enumerable_thread_specific<boost::object_pool<Cube>> pools;
     Cube*                       root_cube { nullptr };
     Vec3d                       origin;
     std::vector<CubeProperties> cubes_properties;
+    // Hash of the vertices of the triangles intersecting a cube. It is 128 bits long, thus the triangles themselves
+    // do not need to be kept to exclude a hash collision.
+    struct TrianglesHash {
+        uint64_t                h1 { 0 };
+        uint64_t                h2 { 0 };
+        bool operator==(const TrianglesHash &rhs) const { return h1 == rhs.h1 && h2 == rhs.h2; }
+        bool operator!=(const TrianglesHash &rhs) const { return ! (*this == rhs); }
+    };
+    // Hashes of the triangles intersecting the cubes with at least MinReusedSubtreeDepth levels of descendants.
+    // When rebuilding the octree, subtrees of cubes intersected by the very same triangles are copied from the old octree.
+    // Only recorded if the octree is rebuilt from an old octree, an octree built once pays nothing for the reuse.
+    std::unordered_map<const Cube*, TrianglesHash> cubes_hashes;
+    // Number of cubes copied from the old octree.
+    size_t                      num_reused_cubes { 0 };
 
-    Octree(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties)
-        : root_cube(pool.construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
+    static constexpr int MinReusedSubtreeDepth = 2;
 
-    void insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth);
+    Octree(const Vec3d &origin, const std::vector<CubeProperties> &cubes_properties)
+        : root_cube(pools.local().construct(origin)), origin(origin), cubes_properties(cubes_properties) {}
 };
 
 void OctreeDeleter::operator()(Octree *p) {
@@ -1460,16 +1482,259 @@ static inline bool is_overhang_triangle(const Vec3d &a, const Vec3d &b, const Ve
     return n.dot(up) > 0.707 * n.norm();
 }
 
-static void transform_center(Cube *current_cube, const Eigen::Matrix3d &rot)
+// Builds the octree top-down: The triangles intersecting a cube are split into the triangles intersecting each of its children,
+// cubes intersected by many triangles are subdivided in parallel.
+class OctreeBuilder
 {
+public:
+    OctreeBuilder(
+        Octree                       &octree,
+        // Vertices of the triangles to be inserted into the octree in the coordinate system of the octree, three vertices per triangle.
+        const std::vector<Vec3d>     &triangles,
+        // Octree built before with the same origin and cubes, its subtrees intersected by the same triangles are reused. May be null.
+        const Octree                 *old_octree,
+        // Record the hashes of the triangles intersecting the cubes to reuse the subtrees of this octree when it is rebuilt.
+        bool                          record_hashes,
+        // Rotation from the coordinate system of the octree to the world coordinates.
+        const Eigen::Matrix3d        &rotation) :
+        m_octree(octree), m_triangles(triangles), m_old_octree(old_octree && ! old_octree->cubes_hashes.empty() ? old_octree : nullptr),
+        m_record_hashes(record_hashes), m_rotation(rotation)
+    {
+        // Subtrees may only be reused if their hashes are known.
+        assert(m_record_hashes || m_old_octree == nullptr);
+    }
+
+    void build()
+    {
+        std::vector<uint32_t> triangles(m_triangles.size() / 3);
+        std::iota(triangles.begin(), triangles.end(), 0);
+        if (m_record_hashes) {
+            m_triangle_hashes.assign(triangles.size(), {});
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, triangles.size(), ParallelGrainSize), [this](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    Octree::TrianglesHash hash { 0x243f6a8885a308d3ull, 0x13198a2e03707344ull };
+                    for (const Vec3d &v : this->triangle(uint32_t(i)))
+                        for (int k = 0; k < 3; ++ k) {
+                            // Hash the bit pattern of the coordinate.
+                            uint64_t bits;
+                            memcpy(&bits, &v[k], sizeof(bits));
+                            hash_append(hash, bits);
+                        }
+                    m_triangle_hashes[i] = hash;
+                }
+            });
+        }
+
+        Cube        *root_cube = m_octree.root_cube;
+        const Vec3d  center    = root_cube->center;
+        const int    max_depth = int(m_octree.cubes_properties.size()) - 1;
+        const double edge_length_half = 0.5 * m_octree.cubes_properties.back().edge_length;
+        const Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
+        const Cube  *old_root_cube = m_old_octree ? m_old_octree->root_cube : nullptr;
+        root_cube->center = m_rotation * center;
 #ifndef NDEBUG
-    current_cube->center_octree = current_cube->center;
+        root_cube->center_octree = center;
 #endif // NDEBUG
-    current_cube->center = rot * current_cube->center;
-    for (auto *child : current_cube->children)
-        if (child)
-            transform_center(child, rot);
-}
+        if (m_record_hashes && max_depth >= Octree::MinReusedSubtreeDepth) {
+            Octree::TrianglesHash hash = this->triangles_hash(triangles);
+            if (this->reusable(old_root_cube, hash)) {
+                // Nothing has changed, copy the whole old octree.
+                for (int i = 0; i < 8; ++ i)
+                    if (old_root_cube->children[i])
+                        root_cube->children[i] = this->copy_subtree(old_root_cube->children[i], max_depth - 1);
+            } else
+                this->build_recursive(root_cube, center, BoundingBoxf3(center - diag_half, center + diag_half), max_depth, old_root_cube, triangles);
+            m_cubes_hashes.local().emplace_back(root_cube, hash);
+        } else
+            this->build_recursive(root_cube, center, BoundingBoxf3(center - diag_half, center + diag_half), max_depth, old_root_cube, triangles);
+
+        for (std::vector<std::pair<const Cube*, Octree::TrianglesHash>> &cubes_hashes : m_cubes_hashes)
+            m_octree.cubes_hashes.insert(cubes_hashes.begin(), cubes_hashes.end());
+        m_octree.num_reused_cubes = m_num_reused_cubes;
+    }
+
+private:
+    // Split the triangle list into parallel tasks of at least this many triangles.
+    static constexpr size_t ParallelGrainSize = 2048;
+
+    tcb::span<const Vec3d, 3> triangle(uint32_t idx) const { return tcb::span<const Vec3d, 3>(m_triangles.data() + 3 * idx, 3); }
+
+    // Mix a value into both halves of a hash, each half with its own constant, see splitmix64.
+    static void hash_append(Octree::TrianglesHash &hash, uint64_t value)
+    {
+        auto mix = [](uint64_t x) {
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+            return x ^ (x >> 31);
+        };
+        hash.h1 = mix(hash.h1 ^ (value + 0x9e3779b97f4a7c15ull));
+        hash.h2 = mix(hash.h2 + (value ^ 0xc2b2ae3d27d4eb4full));
+    }
+
+    Octree::TrianglesHash triangles_hash(const std::vector<uint32_t> &triangles) const
+    {
+        Octree::TrianglesHash hash { triangles.size(), ~ uint64_t(triangles.size()) };
+        for (uint32_t idx : triangles) {
+            hash_append(hash, m_triangle_hashes[idx].h1);
+            hash_append(hash, m_triangle_hashes[idx].h2);
+        }
+        return hash;
+    }
+
+    // Is old_cube intersected by the very same triangles as a new cube with the given hash?
+    bool reusable(const Cube *old_cube, const Octree::TrianglesHash &hash) const
+    {
+        if (old_cube == nullptr)
+            return false;
+        auto it = m_old_octree->cubes_hashes.find(old_cube);
+        return it != m_old_octree->cubes_hashes.end() && it->second == hash;
+    }
+
+    Cube* create_cube(const Vec3d &center)
+    {
+        Cube *cube = m_octree.pools.local().construct(Vec3d(m_rotation * center));
+#ifndef NDEBUG
+        cube->center_octree = center;
+#endif // NDEBUG
+        return cube;
+    }
+
+    // Copy a subtree of the old octree, which is already transformed to world coordinates, together with the hashes of its cubes.
+    Cube* copy_subtree(const Cube *old_cube, int depth)
+    {
+        size_t num_cubes = 0;
+        Cube  *cube      = this->copy_subtree_recursive(old_cube, depth, num_cubes);
+        m_num_reused_cubes += num_cubes;
+        return cube;
+    }
+
+    Cube* copy_subtree_recursive(const Cube *old_cube, int depth, size_t &num_cubes)
+    {
+        Cube *cube = m_octree.pools.local().construct(old_cube->center);
+#ifndef NDEBUG
+        cube->center_octree = old_cube->center_octree;
+#endif // NDEBUG
+        ++ num_cubes;
+        if (depth >= Octree::MinReusedSubtreeDepth)
+            if (auto it = m_old_octree->cubes_hashes.find(old_cube); it != m_old_octree->cubes_hashes.end())
+                m_cubes_hashes.local().emplace_back(cube, it->second);
+        for (int i = 0; i < 8; ++ i)
+            if (old_cube->children[i])
+                cube->children[i] = this->copy_subtree_recursive(old_cube->children[i], depth - 1, num_cubes);
+        return cube;
+    }
+
+    // Split the triangles intersecting a cube into the triangles intersecting each of its children.
+    std::array<std::vector<uint32_t>, 8> split_triangles(const std::vector<uint32_t> &triangles, const std::array<BoundingBoxf3, 8> &child_bboxes) const
+    {
+        auto intersected_children = [this, &child_bboxes](uint32_t idx) {
+            const tcb::span<const Vec3d, 3> tri = this->triangle(idx);
+            uint8_t mask = 0;
+            for (int i = 0; i < 8; ++ i)
+                if (triangle_AABB_intersects(tri[0], tri[1], tri[2], child_bboxes[i]))
+                    mask |= uint8_t(1 << i);
+            return mask;
+        };
+        std::array<std::vector<uint32_t>, 8> out;
+        auto emplace = [&out](uint32_t idx, uint8_t mask) {
+            for (int i = 0; mask; ++ i, mask >>= 1)
+                if (mask & 1)
+                    out[i].emplace_back(idx);
+        };
+        if (triangles.size() < 2 * ParallelGrainSize) {
+            for (uint32_t idx : triangles)
+                emplace(idx, intersected_children(idx));
+        } else {
+            std::vector<uint8_t> masks(triangles.size());
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, triangles.size(), ParallelGrainSize), [&triangles, &masks, &intersected_children](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i)
+                    masks[i] = intersected_children(triangles[i]);
+            });
+            for (size_t i = 0; i < triangles.size(); ++ i)
+                emplace(triangles[i], masks[i]);
+        }
+        return out;
+    }
+
+    void build_recursive(Cube *cube, const Vec3d &center, const BoundingBoxf3 &bbox, int depth, const Cube *old_cube, const std::vector<uint32_t> &triangles)
+    {
+        assert(cube);
+        assert(depth > 0);
+
+        --depth;
+
+        std::array<BoundingBoxf3, 8> child_bboxes;
+        for (size_t i = 0; i < 8; ++ i) {
+            const Vec3d &child_center_dir = child_centers[i];
+            // Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
+            // We will rather densify the octree a bit more than necessary instead of missing a triangle.
+            BoundingBoxf3 &child_bbox = child_bboxes[i];
+            for (int k = 0; k < 3; ++ k) {
+                if (child_center_dir[k] == -1.) {
+                    child_bbox.min[k] = bbox.min[k];
+                    child_bbox.max[k] = center[k] + EPSILON;
+                } else {
+                    child_bbox.min[k] = center[k] - EPSILON;
+                    child_bbox.max[k] = bbox.max[k];
+                }
+            }
+        }
+        std::array<std::vector<uint32_t>, 8> child_triangles = this->split_triangles(triangles, child_bboxes);
+
+        // Children to be subdivided further.
+        std::array<Vec3d, 8>         child_centers_octree;
+        std::array<const Cube*, 8>   old_children {};
+        std::vector<int>             to_subdivide;
+        size_t                       num_triangles_to_subdivide = 0;
+        for (int i = 0; i < 8; ++ i)
+            if (! child_triangles[i].empty()) {
+                if (old_cube)
+                    old_children[i] = old_cube->children[i];
+                if (m_record_hashes && depth >= Octree::MinReusedSubtreeDepth) {
+                    Octree::TrianglesHash hash = this->triangles_hash(child_triangles[i]);
+                    if (this->reusable(old_children[i], hash)) {
+                        // The subtree is intersected by the same triangles as the subtree of the old octree.
+                        cube->children[i] = this->copy_subtree(old_children[i], depth);
+                        continue;
+                    }
+                    child_centers_octree[i] = center + (child_centers[i] * (m_octree.cubes_properties[depth].edge_length / 2.));
+                    cube->children[i] = this->create_cube(child_centers_octree[i]);
+                    m_cubes_hashes.local().emplace_back(cube->children[i], hash);
+                } else {
+                    child_centers_octree[i] = center + (child_centers[i] * (m_octree.cubes_properties[depth].edge_length / 2.));
+                    cube->children[i] = this->create_cube(child_centers_octree[i]);
+                }
+                if (depth > 0) {
+                    to_subdivide.emplace_back(i);
+                    num_triangles_to_subdivide += child_triangles[i].size();
+                }
+            }
+
+        auto subdivide = [&](int i) {
+            this->build_recursive(cube->children[i], child_centers_octree[i], child_bboxes[i], depth, old_children[i], child_triangles[i]);
+        };
+        if (to_subdivide.size() > 1 && num_triangles_to_subdivide >= ParallelGrainSize)
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, to_subdivide.size(), 1), [&to_subdivide, &subdivide](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i)
+                    subdivide(to_subdivide[i]);
+            });
+        else
+            for (int i : to_subdivide)
+                subdivide(i);
+    }
+
+    Octree                                      &m_octree;
+    const std::vector<Vec3d>                    &m_triangles;
+    const Octree                                *m_old_octree;
+    const bool                                   m_record_hashes;
+    const Eigen::Matrix3d                        m_rotation;
+    // Hashes of the triangles inserted into the octree, indexed the same way as m_triangles.
+    std::vector<Octree::TrianglesHash>           m_triangle_hashes;
+    // Hashes of the triangles intersecting the cubes, collected per thread, to be moved to Octree::cubes_hashes.
+    tbb::enumerable_thread_specific<std::vector<std::pair<const Cube*, Octree::TrianglesHash>>> m_cubes_hashes;
+    // Number of cubes copied from the old octree.
+    std::atomic<size_t>                          m_num_reused_cubes { 0 };
+};
 
 OctreePtr build_octree(
     // Mesh is rotated to the coordinate system of the octree.
@@ -1478,7 +1743,8 @@ OctreePtr build_octree(
     // rotated to the coordinate system of the octree.
     const std::vector<Vec3d>    &overhang_triangles, 
     coordf_t                     line_spacing,
-    bool                         support_overhangs_only)
+    bool                         support_overhangs_only,
+    const Octree                *old_octree)
 {
     assert(line_spacing > 0);
     assert(! std::isnan(line_spacing));
@@ -1489,72 +1755,71 @@ OctreePtr build_octree(
     auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
 
     if (cubes_properties.size() > 1) {
-        Octree *octree_ptr = octree.get();
-        double edge_length_half = 0.5 * cubes_properties.back().edge_length;
-        Vec3d  diag_half(edge_length_half, edge_length_half, edge_length_half);
-        int    max_depth = int(cubes_properties.size()) - 1;
-        auto process_triangle = [octree_ptr, max_depth, diag_half](const Vec3d &a, const Vec3d &b, const Vec3d &c) {
-            octree_ptr->insert_triangle(
-                a, b, c,
-                octree_ptr->root_cube,
-                BoundingBoxf3(octree_ptr->root_cube->center - diag_half, octree_ptr->root_cube->center + diag_half),
-                max_depth);
-        };
+        // Transform the octree to world coordinates to reduce computation when extracting infill lines.
+        auto rot = transform_to_world().toRotationMatrix();
+        // The hashes of the triangles intersecting the cubes are only recorded if the octree is being rebuilt,
+        // as it is likely to be rebuilt again.
+        const bool record_hashes = old_octree != nullptr;
+        // Subtrees of the old octree may only be reused if its cubes are placed the same way.
+        if (old_octree && (old_octree->origin != rot * cube_center || old_octree->cubes_properties.size() != cubes_properties.size() ||
+            ! std::equal(cubes_properties.begin(), cubes_properties.end(), old_octree->cubes_properties.begin(),
+                [](const CubeProperties &lhs, const CubeProperties &rhs) { return lhs.edge_length == rhs.edge_length; })))
+            old_octree = nullptr;
+        assert(triangle_mesh.indices.size() + overhang_triangles.size() / 3 < size_t(std::numeric_limits<uint32_t>::max()));
+        std::vector<Vec3d> triangles;
+        triangles.reserve(3 * triangle_mesh.indices.size() + overhang_triangles.size());
         auto up_vector = support_overhangs_only ? Vec3d(transform_to_octree() * Vec3d(0., 0., 1.)) : Vec3d();
-        for (auto &tri : triangle_mesh.indices) {
-            auto a = triangle_mesh.vertices[tri[0]].cast<double>();
-            auto b = triangle_mesh.vertices[tri[1]].cast<double>();
-            auto c = triangle_mesh.vertices[tri[2]].cast<double>();
-            if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector))
-                process_triangle(a, b, c);
-        }
-        for (size_t i = 0; i < overhang_triangles.size(); i += 3)
-            process_triangle(overhang_triangles[i], overhang_triangles[i + 1], overhang_triangles[i + 2]);
-        {
-            // Transform the octree to world coordinates to reduce computation when extracting infill lines.
-            auto rot = transform_to_world().toRotationMatrix();
-            transform_center(octree->root_cube, rot);
-            octree->origin = rot * octree->origin;
+        for (const stl_triangle_vertex_indices &tri : triangle_mesh.indices) {
+            const Vec3d a = triangle_mesh.vertices[tri[0]].cast<double>();
+            const Vec3d b = triangle_mesh.vertices[tri[1]].cast<double>();
+            const Vec3d c = triangle_mesh.vertices[tri[2]].cast<double>();
+            if (! support_overhangs_only || is_overhang_triangle(a, b, c, up_vector)) {
+                triangles.emplace_back(a);
+                triangles.emplace_back(b);
+                triangles.emplace_back(c);
+            }
         }
+        append(triangles, overhang_triangles);
+        OctreeBuilder(*octree, triangles, old_octree, record_hashes, rot).build();
+        octree->origin = rot * octree->origin;
     }
 
     return octree;
 }
 
-void Octree::insert_triangle(const Vec3d &a, const Vec3d &b, const Vec3d &c, Cube *current_cube, const BoundingBoxf3 &current_bbox, int depth)
+size_t octree_num_reused_cubes(const Octree &octree)
 {
-    assert(current_cube);
-    assert(depth > 0);
-
-    --depth;
-
-    // Squared radius of a sphere around the child cube.
-    // const double r2_cube = Slic3r::sqr(0.5 * this->cubes_properties[depth].height + EPSILON);
-
-    for (size_t i = 0; i < 8; ++ i) {
-        const Vec3d &child_center_dir = child_centers[i];
-        // Calculate a slightly expanded bounding box of a child cube to cope with triangles touching a cube wall and other numeric errors.
-        // We will rather densify the octree a bit more than necessary instead of missing a triangle.
-        BoundingBoxf3 bbox;
-        for (int k = 0; k < 3; ++ k) {
-            if (child_center_dir[k] == -1.) {
-                bbox.min[k] = current_bbox.min[k];
-                bbox.max[k] = current_cube->center[k] + EPSILON;
-            } else {
-                bbox.min[k] = current_cube->center[k] - EPSILON;
-                bbox.max[k] = current_bbox.max[k];
-            }
-        }
-        Vec3d child_center = current_cube->center + (child_center_dir * (this->cubes_properties[depth].edge_length / 2.));
-        //if (dist2_to_triangle(a, b, c, child_center) < r2_cube) {
-        // dist2_to_triangle and r2_cube are commented out too.
-        if (triangle_AABB_intersects(a, b, c, bbox)) {
-            if (! current_cube->children[i])
-                current_cube->children[i] = this->pool.construct(child_center);
-            if (depth > 0)
-                this->insert_triangle(a, b, c, current_cube->children[i], bbox, depth);
-        }
-    }
+    return octree.num_reused_cubes;
+}
+
+static size_t num_cubes_recursive(const Cube *cube)
+{
+    size_t num_cubes = 1;
+    for (const Cube *child : cube->children)
+        if (child)
+            num_cubes += num_cubes_recursive(child);
+    return num_cubes;
+}
+
+size_t octree_num_cubes(const Octree &octree)
+{
+    return num_cubes_recursive(octree.root_cube);
+}
+
+static bool cubes_equal_recursive(const Cube *lhs, const Cube *rhs)
+{
+    if (lhs->center != rhs->center)
+        return false;
+    for (int i = 0; i < 8; ++ i)
+        if ((lhs->children[i] == nullptr) != (rhs->children[i] == nullptr) ||
+            (lhs->children[i] && ! cubes_equal_recursive(lhs->children[i], rhs->children[i])))
+            return false;
+    return true;
+}
+
+bool octrees_equal(const Octree &lhs, const Octree &rhs)
+{
+    return lhs.origin == rhs.origin && cubes_equal_recursive(lhs.root_cube, rhs.root_cube);
 }
 
 } // namespace FillAdaptive
@@ -60,7 +60,18 @@ FillAdaptive::OctreePtr         build_octree(
     const std::vector<Vec3d>    &overhang_triangles, 
     coordf_t                     line_spacing, 
     // If true, octree is densified below internal overhangs only.
-    bool                         support_overhangs_only);
+    bool                         support_overhangs_only,
+    // Octree built before for the same object. Its subtrees intersected by the same triangles are copied
+    // instead of being built again. May be null. If supplied, the new octree records the hashes of the triangles
+    // intersecting its cubes for the next rebuild, thus only an octree being rebuilt pays for the reuse.
+    const Octree                *old_octree = nullptr);
+
+// Number of cubes copied from the old octree by build_octree().
+size_t                          octree_num_reused_cubes(const Octree &octree);
+// Number of cubes of an octree.
+size_t                          octree_num_cubes(const Octree &octree);
+// Compare the cubes of two octrees node by node.
+bool                            octrees_equal(const Octree &lhs, const Octree &rhs);
 
 //
 // Some of the algorithms used by class FillAdaptive were inspired by
@@ -127,7 +127,7 @@ void Generator::generateTrees(const PrintObject &print_object, const std::functi
         const BoundingBox &current_outlines_bbox   = get_extents(current_outlines);
 
         // register all trees propagated from the previous layer as to-be-reconnected
-        std::vector<NodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
+        std::vector<NodeIdx> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
 
         current_lightning_layer.generateNewTrees(m_overhang_per_layer[layer_id], current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
         current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius);
@@ -142,14 +142,14 @@ void Generator::generateTrees(const PrintObject &print_object, const std::functi
             below_outlines_bbox.merge(outlines_locator_bbox);
 
         if (!current_lightning_layer.tree_roots.empty())
-            below_outlines_bbox.merge(get_extents(current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
+            below_outlines_bbox.merge(get_extents(current_lightning_layer.nodes, current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
 
         outlines_locator.set_bbox(below_outlines_bbox);
         outlines_locator.create(below_outlines, locator_cell_size);
 
-        std::vector<NodeSPtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
-        for (auto& tree : current_lightning_layer.tree_roots)
-            tree->propagateToNextLayer(lower_trees, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, locator_cell_size / 2);
+        Layer &lower_lightning_layer = m_lightning_layers[layer_id - 1];
+        for (NodeIdx tree : current_lightning_layer.tree_roots)
+            current_lightning_layer.nodes.propagateToNextLayer(tree, lower_lightning_layer.nodes, lower_lightning_layer.tree_roots, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, locator_cell_size / 2);
     }
 }
 
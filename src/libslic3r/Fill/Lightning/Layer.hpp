@@ -13,6 +13,7 @@
 
 #include "../../EdgeGrid.hpp"
 #include "../../Polygon.hpp"
+#include "TreeNode.hpp"
 #include "libslic3r/BoundingBox.hpp"
 #include "libslic3r/Point.hpp"
 #include "libslic3r/Polyline.hpp"
@@ -21,16 +22,13 @@
 namespace Slic3r::FillLightning
 {
 
-class Node;
-
-using NodeSPtr = std::shared_ptr<Node>;
-using SparseNodeGrid = std::unordered_multimap<Point, std::weak_ptr<Node>, PointHash>;
+using SparseNodeGrid = std::unordered_multimap<Point, NodeIdx, PointHash>;
 
 struct GroundingLocation
 {
-    NodeSPtr tree_node; //!< not null if the gounding location is on a tree
+    NodeIdx tree_node; //!< valid if the gounding location is on a tree
     std::optional<Point> boundary_location; //!< in case the gounding location is on the boundary
-    Point p() const;
+    Point p(const NodePool &nodes) const;
 };
 
 /*!
@@ -41,7 +39,9 @@ struct GroundingLocation
 class Layer
 {
 public:
-    std::vector<NodeSPtr> tree_roots;
+    // Nodes of all the trees of this layer.
+    NodePool nodes;
+    std::vector<NodeIdx> tree_roots;
 
     void generateNewTrees
     (
@@ -66,7 +66,7 @@ public:
         coord_t supporting_radius,
         coord_t wall_supporting_radius,
         const SparseNodeGrid& tree_node_locator,
-        const NodeSPtr& exclude_tree = nullptr
+        NodeIdx exclude_tree = InvalidNodeIdx
     );
 
     /*!
@@ -74,11 +74,11 @@ public:
      * \param[out] new_root The new root node if one had been made
      * \return Whether a new root was added
      */
-    bool attach(const Point& unsupported_location, const GroundingLocation& ground, NodeSPtr& new_child, NodeSPtr& new_root);
+    bool attach(const Point& unsupported_location, const GroundingLocation& ground, NodeIdx& new_child, NodeIdx& new_root);
 
     void reconnectRoots
     (
-        std::vector<NodeSPtr>& to_be_reconnected_tree_roots,
+        std::vector<NodeIdx>& to_be_reconnected_tree_roots,
         const Polygons& current_outlines,
         const BoundingBox& current_outlines_bbox,
         const EdgeGrid::Grid& outline_locator,
@@ -13,6 +13,8 @@
 #include <utility>
 #include <cinttypes>
 #include <cstddef>
+#include <cassert>
+#include <limits>
 
 #include "libslic3r/EdgeGrid.hpp"
 #include "libslic3r/Polygon.hpp"
@@ -29,9 +31,9 @@ namespace Slic3r::FillLightning
 
 constexpr auto locator_cell_size = scaled<coord_t>(4.);
 
-class Node;
-
-using NodeSPtr = std::shared_ptr<Node>;
+// Index of a node into the NodePool of a lightning layer.
+using NodeIdx = uint32_t;
+constexpr NodeIdx InvalidNodeIdx = std::numeric_limits<NodeIdx>::max();
 
 // NOTE: As written, this struct will only be valid for a single layer, will have to be updated for the next.
 // NOTE: Reasons for implementing this with some separate closures:
@@ -44,21 +46,13 @@ using NodeSPtr = std::shared_ptr<Node>;
  *
  * In essence these vertices are just a position linked to other positions in
  * 2D. The nodes have a hierarchical structure of parents and children, forming
- * a tree. The class also has some helper functions specific to Lightning Infill
- * e.g. to straighten the paths around this node.
+ * a tree. The nodes are stored in a NodePool and linked by their indices into
+ * the pool, the pool implements the operations on the trees.
  */
-class Node : public std::enable_shared_from_this<Node>
+class Node
 {
 public:
-    // Workaround for private/protected constructors and 'make_shared': https://stackoverflow.com/a/27832765
-    template<typename ...Arg> NodeSPtr static create(Arg&&...arg)
-    {
-        struct EnableMakeShared : public Node
-        {
-            explicit EnableMakeShared(Arg&&...arg) : Node(std::forward<Arg>(arg)...) {}
-        };
-        return std::make_shared<EnableMakeShared>(std::forward<Arg>(arg)...);
-    }
+    Node() = delete; // Don't allow empty contruction
 
     /*!
      * Get the position on this layer that this node represents, a vertex of the
@@ -73,28 +67,92 @@ public:
      */
     void setLocation(const Point& p) { m_p = p; }
 
+    /*!
+     * Returns whether this node is the root of a lightning tree. It is the root
+     * if it has no parents.
+     * \return ``true`` if this node is the root (no parents) or ``false`` if it
+     * is a child node of some other node.
+     */
+    bool isRoot() const { return m_is_root; }
+
+    NodeIdx parent() const { return m_parent; }
+    const std::vector<NodeIdx>& children() const { return m_children; }
+
+    /*! If this was ever a direct child of the root, it'll have a previous grounding location.
+     *
+     * This needs to be known when roots are reconnected, so that the last (higher) layer is supported by the next one.
+     */
+    const std::optional<Point>& getLastGroundingLocation() const { return m_last_grounding_location; }
+
+private:
+    /*!
+     * Construct a new node, either for insertion in a tree or as root.
+     * \param p The physical location in the 2D layer that this node represents.
+     * Connecting other nodes to this node indicates that a line segment should
+     * be drawn between those two physical positions.
+     */
+    explicit Node(const Point& p, const std::optional<Point>& last_grounding_location = std::nullopt) :
+        m_is_root(true), m_p(p), m_parent(InvalidNodeIdx), m_last_grounding_location(last_grounding_location) {}
+
+    bool m_is_root;
+    Point m_p;
+    NodeIdx m_parent;
+    std::vector<NodeIdx> m_children;
+
+    std::optional<Point> m_last_grounding_location;  //<! The last known grounding location, see 'getLastGroundingLocation()'.
+
+    friend class NodePool;
+};
+
+/*!
+ * Flat storage of the nodes of the lightning trees of a single layer.
+ *
+ * The nodes link their parents and children by indices into the pool. The slots
+ * of the nodes removed from the trees by pruning, straightening or realigning
+ * are reused by the nodes created later. Indices of the nodes are stable, thus
+ * a node may be referenced by its index for as long as it is part of a tree.
+ */
+class NodePool
+{
+public:
+    /*!
+     * Construct a new root node.
+     * \param p The location of the new node.
+     * \param last_grounding_location The last known grounding location of the new node.
+     * \return Index of the new node.
+     */
+    NodeIdx create(const Point& p, const std::optional<Point>& last_grounding_location = std::nullopt);
+
+    const Node& operator[](NodeIdx idx) const { assert(idx < m_nodes.size()); return m_nodes[idx]; }
+
+    // Number of the nodes allocated from the pool and not released.
+    size_t size() const { return m_nodes.size() - m_free.size(); }
+    // Number of the slots of the pool, both allocated and released.
+    size_t capacity() const { return m_nodes.size(); }
+
     /*!
      * Construct a new ``Node`` instance and add it as a child of
-     * this node.
+     * \p parent.
      * \param p The location of the new node.
-     * \return A shared pointer to the new node.
+     * \return Index of the new node.
      */
-    NodeSPtr addChild(const Point& p);
+    NodeIdx addChild(NodeIdx parent, const Point& p);
 
     /*!
-     * Add an existing ``Node`` as a child of this node.
+     * Add an existing ``Node`` as a child of \p parent.
      * \param new_child The node that must be added as a child.
      * \return Always returns \p new_child.
      */
-    NodeSPtr addChild(NodeSPtr& new_child);
+    NodeIdx addChild(NodeIdx parent, NodeIdx new_child);
 
     /*!
-     * Propagate this node's sub-tree to the next layer.
+     * Propagate the sub-tree of \p node to the next layer.
      *
-     * Creates a copy of this tree, realign it to the new layer boundaries
-     * \p next_outlines and reduce (i.e. prune and straighten) it. A copy of
-     * this node and all of its descendant nodes will be added to the
+     * Creates a copy of this tree in \p next_pool, realign it to the new layer
+     * boundaries \p next_outlines and reduce (i.e. prune and straighten) it.
+     * A copy of this node and all of its descendant nodes will be added to the
      * \p next_trees vector.
+     * \param next_pool Node pool of the next layer.
      * \param next_trees A collection of tree nodes to use for the next layer.
      * \param next_outlines The shape of the layer below, to make sure that the
      * tree stays within the bounds of the infill area.
@@ -108,7 +166,9 @@ public:
      */
     void propagateToNextLayer
     (
-        std::vector<NodeSPtr>& next_trees,
+        NodeIdx node,
+        NodePool& next_pool,
+        std::vector<NodeIdx>& next_trees,
         const Polygons& next_outlines,
         const EdgeGrid::Grid& outline_locator,
         coord_t prune_distance,
@@ -117,7 +177,7 @@ public:
     ) const;
 
     /*!
-     * Executes a given function for every line segment in this node's sub-tree.
+     * Executes a given function for every line segment in \p node's sub-tree.
      *
      * The function takes two `Point` arguments. These arguments will be filled
      * in with the higher-order node (closer to the root) first, and the
@@ -127,22 +187,20 @@ public:
      * \param visitor A function to execute for every branch in the node's sub-
      * tree.
      */
-    void visitBranches(const std::function<void(const Point&, const Point&)>& visitor) const;
+    void visitBranches(NodeIdx node, const std::function<void(const Point&, const Point&)>& visitor) const;
 
     /*!
-     * Execute a given function for every node in this node's sub-tree.
+     * Execute a given function for every node in \p node's sub-tree.
      *
-     * The visitor function takes a node as input. This node is not const, so
-     * this can be used to change the tree.
-     * Nodes are visited in depth-first order. This node itself is visited as
+     * Nodes are visited in depth-first order. The node itself is visited as
      * well (pre-order).
      * \param visitor A function to execute for every node in this node's sub-
      * tree.
      */
-    void visitNodes(const std::function<void(NodeSPtr)>& visitor);
+    void visitNodes(NodeIdx node, const std::function<void(NodeIdx)>& visitor) const;
 
     /*!
-     * Get a weighted distance from an unsupported point to this node (given the current supporting radius).
+     * Get a weighted distance from an unsupported point to \p node (given the current supporting radius).
      *
      * When attaching a unsupported location to a node, not all nodes have the same priority.
      * (Eucludian) closer nodes are prioritised, but that's not the whole story.
@@ -151,65 +209,65 @@ public:
      * \param supporting_radius The maximum distance which can be bridged without (infill) supporting it.
      * \return The weighted distance.
      */
-    coord_t getWeightedDistance(const Point& unsupported_location, const coord_t& supporting_radius) const;
+    coord_t getWeightedDistance(NodeIdx node, const Point& unsupported_location, const coord_t& supporting_radius) const;
 
     /*!
-     * Returns whether this node is the root of a lightning tree. It is the root
-     * if it has no parents.
-     * \return ``true`` if this node is the root (no parents) or ``false`` if it
-     * is a child node of some other node.
-     */
-    bool isRoot() const { return m_is_root; }
-
-    /*!
-     * Reverse the parent-child relationship all the way to the root, from this node onward.
-     * This has the effect of 're-rooting' the tree at the current node if no immediate parent is given as argument.
-     * That is, the current node will become the root, it's (former) parent if any, will become one of it's children.
+     * Reverse the parent-child relationship all the way to the root, from \p node onward.
+     * This has the effect of 're-rooting' the tree at the node if no immediate parent is given as argument.
+     * That is, the node will become the root, it's (former) parent if any, will become one of it's children.
      * This is then recursively bubbled up until it reaches the (former) root, which then will become a leaf.
      * \param new_parent The (new) parent-node of the root, useful for recursing or immediately attaching the node to another tree.
      */
-    void reroot(const NodeSPtr &new_parent = nullptr);
+    void reroot(NodeIdx node, NodeIdx new_parent = InvalidNodeIdx);
 
     /*!
      * Retrieves the closest node to the specified location.
      * \param loc The specified location.
-     * \result The branch that starts at the position closest to the location within this tree.
+     * \result The branch that starts at the position closest to the location within the tree of \p node.
      */
-    NodeSPtr closestNode(const Point& loc);
+    NodeIdx closestNode(NodeIdx node, const Point& loc) const;
 
     /*!
-     * Returns whether the given tree node is a descendant of this node.
+     * Returns whether the given tree node is a descendant of \p node.
      *
-     * If this node itself is given, it is also considered to be a descendant.
+     * If the node itself is given, it is also considered to be a descendant.
      * \param to_be_checked A node to find out whether it is a descendant of
-     * this node.
-     * \return ``true`` if the given node is a descendant or this node itself,
+     * \p node.
+     * \return ``true`` if the given node is a descendant or the node itself,
      * or ``false`` if it is not in the sub-tree.
      */
-    bool hasOffspring(const NodeSPtr& to_be_checked) const;
-
-    Node() = delete; // Don't allow empty contruction
+    bool hasOffspring(NodeIdx node, NodeIdx to_be_checked) const;
 
-protected:
     /*!
-     * Construct a new node, either for insertion in a tree or as root.
-     * \param p The physical location in the 2D layer that this node represents.
-     * Connecting other nodes to this node indicates that a line segment should
-     * be drawn between those two physical positions.
+     * Convert the tree into polylines
+     * 
+     * At each junction one line is chosen at random to continue
+     * 
+     * The lines start at a leaf and end in a junction
+     * 
+     * \param output all branches in this tree connected into polylines
      */
-    explicit Node(const Point& p, const std::optional<Point>& last_grounding_location = std::nullopt);
+    void convertToPolylines(NodeIdx root, Polylines &output, coord_t line_overlap) const;
+
+private:
+    Node& node(NodeIdx idx) { assert(idx < m_nodes.size()); return m_nodes[idx]; }
+
+    // Return the slot of a node removed from the trees to the pool.
+    void release(NodeIdx idx);
+    // Release a node together with all of its descendants.
+    void releaseSubtree(NodeIdx idx);
 
     /*!
-     * Copy this node and its entire sub-tree.
+     * Copy a node of another pool and its entire sub-tree into this pool.
      * \return The equivalent of this node in the copy (the root of the new sub-
      * tree).
      */
-    NodeSPtr deepCopy() const;
+    NodeIdx deepCopy(const NodePool& src, NodeIdx src_node);
 
     /*! Reconnect trees from the layer above to the new outlines of the lower layer.
      * \return Wether or not the root is kept (false is no, true is yes).
      */
-    bool realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeSPtr>& rerooted_parts);
+    bool realign(NodeIdx node, const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeIdx>& rerooted_parts);
 
     struct RectilinearJunction
     {
@@ -223,7 +281,7 @@ protected:
      * \param magnitude The maximum allowed distance to move the node.
      * \param max_remove_colinear_dist Maximum distance of the (compound) line-segment from which a co-linear point may be removed.
      */
-    void straighten(coord_t magnitude, coord_t max_remove_colinear_dist);
+    void straighten(NodeIdx node, coord_t magnitude, coord_t max_remove_colinear_dist);
 
     /*! Recursive part of \ref straighten(.)
      * \param junction_above The last seen junction with multiple children above
@@ -231,32 +289,13 @@ protected:
      * \param max_remove_colinear_dist2 Maximum distance _squared_ of the (compound) line-segment from which a co-linear point may be removed.
      * \return the total distance along the tree from the last junction above to the first next junction below and the location of the next junction below
      */
-    RectilinearJunction straighten(coord_t magnitude, const Point& junction_above, coord_t accumulated_dist, int64_t max_remove_colinear_dist2);
+    RectilinearJunction straighten(NodeIdx node, coord_t magnitude, const Point& junction_above, coord_t accumulated_dist, int64_t max_remove_colinear_dist2);
 
     /*! Prune the tree from the extremeties (leaf-nodes) until the pruning distance is reached.
      * \return The distance that has been pruned. If less than \p distance, then the whole tree was puned away.
      */
-    coord_t prune(const coord_t& distance);
+    coord_t prune(NodeIdx node, const coord_t& distance);
 
-public:
-    /*!
-     * Convert the tree into polylines
-     * 
-     * At each junction one line is chosen at random to continue
-     * 
-     * The lines start at a leaf and end in a junction
-     * 
-     * \param output all branches in this tree connected into polylines
-     */
-    void convertToPolylines(Polylines &output, coord_t line_overlap) const;
-
-    /*! If this was ever a direct child of the root, it'll have a previous grounding location.
-     *
-     * This needs to be known when roots are reconnected, so that the last (higher) layer is supported by the next one.
-     */
-    const std::optional<Point>& getLastGroundingLocation() const { return m_last_grounding_location; }
-
-protected:
     /*!
      * Convert the tree into polylines
      * 
@@ -267,49 +306,38 @@ protected:
      * \param long_line a reference to a polyline in \p output which to continue building on in the recursion
      * \param output all branches in this tree connected into polylines
      */
-    void convertToPolylines(size_t long_line_idx, Polylines &output) const;
+    void convertToPolylines(NodeIdx node, size_t long_line_idx, Polylines &output) const;
 
-    void removeJunctionOverlap(Polylines &polylines, coord_t line_overlap) const;
-
-    bool m_is_root;
-    Point m_p;
-    std::weak_ptr<Node> m_parent;
-    std::vector<NodeSPtr> m_children;
+    static void removeJunctionOverlap(Polylines &polylines, coord_t line_overlap);
 
-    std::optional<Point> m_last_grounding_location;  //<! The last known grounding location, see 'getLastGroundingLocation()'.
-
-    friend BoundingBox get_extents(const NodeSPtr &root_node);
-    friend BoundingBox get_extents(const std::vector<NodeSPtr> &tree_roots);
-
-#ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
-    friend void export_to_svg(const NodeSPtr &root_node, Slic3r::SVG &svg);
-    friend void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodeSPtr> &root_nodes);
-#endif /* LIGHTNING_TREE_NODE_DEBUG_OUTPUT */
+    std::vector<Node>    m_nodes;
+    // Indices of the released slots of m_nodes to be reused by create().
+    std::vector<NodeIdx> m_free;
 };
 
 bool inside(const Polygons &polygons, const Point &p);
 bool lineSegmentPolygonsIntersection(const Point& a, const Point& b, const EdgeGrid::Grid& outline_locator, Point& result, coord_t within_max_dist);
 
-inline BoundingBox get_extents(const NodeSPtr &root_node)
+inline BoundingBox get_extents(const NodePool &nodes, NodeIdx root_node)
 {
     BoundingBox bbox;
-    for (const NodeSPtr &children : root_node->m_children)
-        bbox.merge(get_extents(children));
-    bbox.merge(root_node->getLocation());
+    for (NodeIdx child : nodes[root_node].children())
+        bbox.merge(get_extents(nodes, child));
+    bbox.merge(nodes[root_node].getLocation());
     return bbox;
 }
 
-inline BoundingBox get_extents(const std::vector<NodeSPtr> &tree_roots)
+inline BoundingBox get_extents(const NodePool &nodes, const std::vector<NodeIdx> &tree_roots)
 {
     BoundingBox bbox;
-    for (const NodeSPtr &root_node : tree_roots)
-        bbox.merge(get_extents(root_node));
+    for (NodeIdx root_node : tree_roots)
+        bbox.merge(get_extents(nodes, root_node));
     return bbox;
 }
 
 #ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
-void export_to_svg(const NodeSPtr &root_node, SVG &svg);
-void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodeSPtr> &root_nodes);
+void export_to_svg(const NodePool &nodes, NodeIdx root_node, SVG &svg);
+void export_to_svg(const std::string &path, const Polygons &contour, const NodePool &nodes, const std::vector<NodeIdx> &root_nodes);
 #endif /* LIGHTNING_TREE_NODE_DEBUG_OUTPUT */
 
 } // namespace Slic3r::FillLightning
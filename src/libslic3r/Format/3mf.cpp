@@ -12,12 +12,17 @@
 #include "libslic3r/GCode/ThumbnailData.hpp"
 #include "libslic3r/Semver.hpp"
 #include "libslic3r/Time.hpp"
+#include "libslic3r/Channel.hpp"
+#include "libslic3r/Thread.hpp"
 
 #include "libslic3r/I18N.hpp"
 
 #include "3mf.hpp"
 
+#include <atomic>
+#include <charconv>
 #include <limits>
+#include <memory>
 #include <stdexcept>
 #include <optional>
 #include <string_view>
@@ -49,12 +54,28 @@ namespace pt = boost::property_tree;
 
 #include <fast_float.h>
 
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
 // https://github.com/boostorg/spirit/pull/586
 // where the exported string is one digit shorter than it should be to guarantee lossless round trip.
 // The code is left here for the ocasion boost guys improve.
 #define EXPORT_3MF_USE_SPIRIT_KARMA_FP 0
 
+// Number of vertices or triangles serialized and deflated as a single chunk of the model file.
+static constexpr const size_t EXPORT_3MF_CHUNK_SIZE = 32 * 1024;
+// Maximum number of chunks of the model file being serialized and deflated at the same time.
+static constexpr const size_t EXPORT_3MF_MAX_CHUNKS_IN_FLIGHT = 16;
+
 // VERSION NUMBERS
 // 0 : .3mf, files saved by older slic3r or other applications. No version definition in them.
 // 1 : Introduction of 3mf versioning. No other change in data saved into 3mf files.
@@ -92,6 +113,11 @@ const std::string SLA_DRAIN_HOLES_FILE = "Metadata/Slic3r_PE_sla_drain_holes.txt
 const std::string CUSTOM_GCODE_PER_PRINT_Z_FILE = "Metadata/Prusa_Slicer_custom_gcode_per_print_z.xml";
 const std::string CUT_INFORMATION_FILE = "Metadata/Prusa_Slicer_cut_information.xml";
 
+// .model files of at least this size are inflated on a worker thread while being parsed.
+static constexpr const size_t MODEL_INFLATE_ASYNC_MIN_SIZE = 4 * 1024 * 1024;
+static constexpr const size_t MODEL_INFLATE_ASYNC_BUFFER_SIZE = 256 * 1024;
+static constexpr const size_t MODEL_INFLATE_ASYNC_NUM_BUFFERS = 4;
+
 static constexpr const char *RELATIONSHIP_TAG = "Relationship";
 
 static constexpr const char* TARGET_ATTR = "Target";
@@ -546,6 +572,8 @@ namespace Slic3r {
         bool _load_model_from_file(const std::string& filename, Model& model, DynamicPrintConfig& config, ConfigSubstitutionContext& config_substitutions);
         bool _extract_relationships_from_archive(mz_zip_archive &archive, const mz_zip_archive_file_stat &stat);
         bool _extract_model_from_archive(mz_zip_archive &archive, const mz_zip_archive_file_stat &stat);
+        template<typename ParseFn>
+        mz_bool _extract_model_from_archive_async(mz_zip_archive &archive, const mz_zip_archive_file_stat &stat, ParseFn &parse);
         bool _is_svg_shape_file(const std::string &filename) const;
         void _extract_cut_information_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat, ConfigSubstitutionContext& config_substitutions);
         void _extract_layer_heights_profile_config_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
@@ -1077,31 +1105,32 @@ namespace Slic3r {
         XML_SetElementHandler(m_xml_parser, _3MF_Importer::_handle_start_model_xml_element, _3MF_Importer::_handle_end_model_xml_element);
         XML_SetCharacterDataHandler(m_xml_parser, _3MF_Importer::_handle_model_xml_characters);
 
-        struct CallbackData
-        {
-            XML_Parser& parser;
-            _3MF_Importer& importer;
-            const mz_zip_archive_file_stat& stat;
-
-            CallbackData(XML_Parser& parser, _3MF_Importer& importer, const mz_zip_archive_file_stat& stat) : parser(parser), importer(importer), stat(stat) {}
+        auto parse = [this, &stat](const char *data, size_t n, bool is_final) {
+            if (!XML_Parse(m_xml_parser, data, (int)n, is_final ? 1 : 0) || this->parse_error()) {
+                char error_buf[1024];
+                ::sprintf(error_buf, "Error (%s) while parsing '%s' at line %d", this->parse_error_message(), stat.m_filename, (int)XML_GetCurrentLineNumber(m_xml_parser));
+                throw Slic3r::FileIOError(error_buf);
+            }
         };
 
-        CallbackData data(m_xml_parser, *this, stat);
-
         mz_bool res = 0;
 
         try
         {
-            res = mz_zip_reader_extract_to_callback(&archive, stat.m_file_index, [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
-                CallbackData* data = (CallbackData*)pOpaque;
-                if (!XML_Parse(data->parser, (const char*)pBuf, (int)n, (file_ofs + n == data->stat.m_uncomp_size) ? 1 : 0) || data->importer.parse_error()) {
-                    char error_buf[1024];
-                    ::sprintf(error_buf, "Error (%s) while parsing '%s' at line %d", data->importer.parse_error_message(), data->stat.m_filename, (int)XML_GetCurrentLineNumber(data->parser));
-                    throw Slic3r::FileIOError(error_buf);
-                }
-
-                return n;
-                }, &data, 0);
+            if (stat.m_uncomp_size < MODEL_INFLATE_ASYNC_MIN_SIZE) {
+                struct CallbackData
+                {
+                    decltype(parse)& parse_fn;
+                    const mz_zip_archive_file_stat& stat;
+                };
+                CallbackData data{ parse, stat };
+                res = mz_zip_reader_extract_to_callback(&archive, stat.m_file_index, [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
+                    CallbackData* data = (CallbackData*)pOpaque;
+                    data->parse_fn((const char*)pBuf, n, file_ofs + n == data->stat.m_uncomp_size);
+                    return n;
+                    }, &data, 0);
+            } else
+                res = _extract_model_from_archive_async(archive, stat, parse);
         }
         catch (const version_error& e)
         {
@@ -1122,6 +1151,84 @@ namespace Slic3r {
         return true;
     }
 
+    template<typename ParseFn>
+    mz_bool _3MF_Importer::_extract_model_from_archive_async(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat, ParseFn &parse)
+    {
+        // Large .model files: Inflate on a worker thread into a small pool of recycled buffers,
+        // while the XML parser consumes the buffers already inflated on this thread.
+        struct Chunk
+        {
+            std::vector<char> data;
+            // Inflating finished, this is the last chunk.
+            bool              last { false };
+            // Inflating finished with success.
+            bool              ok   { false };
+        };
+
+        struct WorkerData
+        {
+            Channel<std::vector<char>> free_buffers;
+            Channel<Chunk>             inflated;
+            std::atomic<bool>          abort { false };
+            std::vector<char>          buffer;
+        };
+
+        WorkerData data;
+        for (size_t i = 0; i < MODEL_INFLATE_ASYNC_NUM_BUFFERS; ++ i)
+            data.free_buffers.push(std::vector<char>());
+
+        boost::thread worker = create_thread([&archive, &stat, &data]() {
+            Chunk last_chunk;
+            last_chunk.last = true;
+            try {
+                data.buffer = data.free_buffers.pop();
+                last_chunk.ok = mz_zip_reader_extract_to_callback(&archive, stat.m_file_index, [](void* pOpaque, mz_uint64 /* file_ofs */, const void* pBuf, size_t n)->size_t {
+                    WorkerData *data = (WorkerData*)pOpaque;
+                    if (data->abort)
+                        // Stop inflating, the parser failed.
+                        return 0;
+                    data->buffer.insert(data->buffer.end(), (const char*)pBuf, (const char*)pBuf + n);
+                    if (data->buffer.size() >= MODEL_INFLATE_ASYNC_BUFFER_SIZE) {
+                        data->inflated.push(Chunk{ std::move(data->buffer) });
+                        // Blocks until the parser returns a buffer.
+                        data->buffer = data->free_buffers.pop();
+                        data->buffer.clear();
+                    }
+                    return n;
+                    }, &data, 0);
+            } catch (...) {
+                // Only std::bad_alloc is expected here, report it as a ZIP extraction failure.
+                last_chunk.ok = false;
+            }
+            last_chunk.data = std::move(data.buffer);
+            data.inflated.push(std::move(last_chunk));
+        });
+
+        mz_bool res = 0;
+        try {
+            for (;;) {
+                Chunk chunk = data.inflated.pop();
+                if (chunk.last) {
+                    if (chunk.ok) {
+                        parse(chunk.data.data(), chunk.data.size(), true);
+                        res = 1;
+                    }
+                    break;
+                }
+                parse(chunk.data.data(), chunk.data.size(), false);
+                data.free_buffers.push(std::move(chunk.data));
+            }
+        } catch (...) {
+            // Wake up the worker if it is waiting for a free buffer, it will stop inflating.
+            data.abort = true;
+            data.free_buffers.push(std::vector<char>());
+            worker.join();
+            throw;
+        }
+        worker.join();
+        return res;
+    }
+
     void _3MF_Importer::_extract_cut_information_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat, ConfigSubstitutionContext& config_substitutions)
     {
         if (stat.m_uncomp_size > 0) {
@@ -1657,7 +1764,12 @@ namespace Slic3r {
         bool res = true;
         unsigned int num_attributes = (unsigned int)XML_GetSpecifiedAttributeCount(m_xml_parser);
 
-        if (::strcmp(MODEL_TAG, name) == 0)
+        // Test the tags of the vertices and triangles first, they are the vast majority of the elements.
+        if (::strcmp(VERTEX_TAG, name) == 0)
+            res = _handle_start_vertex(attributes, num_attributes);
+        else if (::strcmp(TRIANGLE_TAG, name) == 0)
+            res = _handle_start_triangle(attributes, num_attributes);
+        else if (::strcmp(MODEL_TAG, name) == 0)
             res = _handle_start_model(attributes, num_attributes);
         else if (::strcmp(RESOURCES_TAG, name) == 0)
             res = _handle_start_resources(attributes, num_attributes);
@@ -1667,12 +1779,8 @@ namespace Slic3r {
             res = _handle_start_mesh(attributes, num_attributes);
         else if (::strcmp(VERTICES_TAG, name) == 0)
             res = _handle_start_vertices(attributes, num_attributes);
-        else if (::strcmp(VERTEX_TAG, name) == 0)
-            res = _handle_start_vertex(attributes, num_attributes);
         else if (::strcmp(TRIANGLES_TAG, name) == 0)
             res = _handle_start_triangles(attributes, num_attributes);
-        else if (::strcmp(TRIANGLE_TAG, name) == 0)
-            res = _handle_start_triangle(attributes, num_attributes);
         else if (::strcmp(COMPONENTS_TAG, name) == 0)
             res = _handle_start_components(attributes, num_attributes);
         else if (::strcmp(COMPONENT_TAG, name) == 0)
@@ -1695,7 +1803,11 @@ namespace Slic3r {
 
         bool res = true;
 
-        if (::strcmp(MODEL_TAG, name) == 0)
+        if (::strcmp(VERTEX_TAG, name) == 0)
+            res = _handle_end_vertex();
+        else if (::strcmp(TRIANGLE_TAG, name) == 0)
+            res = _handle_end_triangle();
+        else if (::strcmp(MODEL_TAG, name) == 0)
             res = _handle_end_model();
         else if (::strcmp(RESOURCES_TAG, name) == 0)
             res = _handle_end_resources();
@@ -1705,12 +1817,8 @@ namespace Slic3r {
             res = _handle_end_mesh();
         else if (::strcmp(VERTICES_TAG, name) == 0)
             res = _handle_end_vertices();
-        else if (::strcmp(VERTEX_TAG, name) == 0)
-            res = _handle_end_vertex();
         else if (::strcmp(TRIANGLES_TAG, name) == 0)
             res = _handle_end_triangles();
-        else if (::strcmp(TRIANGLE_TAG, name) == 0)
-            res = _handle_end_triangle();
         else if (::strcmp(COMPONENTS_TAG, name) == 0)
             res = _handle_end_components();
         else if (::strcmp(COMPONENT_TAG, name) == 0)
@@ -1928,10 +2036,15 @@ namespace Slic3r {
     {
         // appends the vertex coordinates
         // missing values are set equal to ZERO
-        m_curr_object.geometry.vertices.emplace_back(
-            m_unit_factor * get_attribute_value_float(attributes, num_attributes, X_ATTR),
-            m_unit_factor * get_attribute_value_float(attributes, num_attributes, Y_ATTR),
-            m_unit_factor * get_attribute_value_float(attributes, num_attributes, Z_ATTR));
+        // This is the hot path of 3MF import, thus the attributes are scanned just once for the "x", "y" and "z" keys
+        // instead of looking up the keys one by one with get_attribute_value_float().
+        Vec3f vertex = Vec3f::Zero();
+        for (unsigned int a = 0; a + 1 < num_attributes; a += 2)
+            if (const char *key = attributes[a]; key[0] >= 'x' && key[0] <= 'z' && key[1] == 0) {
+                const char *text = attributes[a + 1];
+                fast_float::from_chars(text, text + strlen(text), vertex[key[0] - 'x']);
+            }
+        m_curr_object.geometry.vertices.emplace_back(m_unit_factor * vertex);
         return true;
     }
 
@@ -1965,21 +2078,37 @@ namespace Slic3r {
 
         // appends the triangle's vertices indices
         // missing values are set equal to ZERO
-        m_curr_object.geometry.triangles.emplace_back(
-            get_attribute_value_int(attributes, num_attributes, V1_ATTR),
-            get_attribute_value_int(attributes, num_attributes, V2_ATTR),
-            get_attribute_value_int(attributes, num_attributes, V3_ATTR));
+        // Like _handle_start_vertex(), the attributes are scanned just once.
+        Vec3i       triangle        = Vec3i::Zero();
+        const char *custom_supports = nullptr;
+        const char *custom_seam     = nullptr;
+        const char *mm_segmentation = nullptr;
+        const char *paint_color     = nullptr;
+        for (unsigned int a = 0; a + 1 < num_attributes; a += 2) {
+            const char *key  = attributes[a];
+            const char *text = attributes[a + 1];
+            if (key[0] == 'v' && key[1] >= '1' && key[1] <= '3' && key[2] == 0)
+                boost::spirit::qi::parse(text, text + strlen(text), boost::spirit::qi::int_, triangle[key[1] - '1']);
+            else if (::strcmp(key, CUSTOM_SUPPORTS_ATTR) == 0)
+                custom_supports = text;
+            else if (::strcmp(key, CUSTOM_SEAM_ATTR) == 0)
+                custom_seam = text;
+            else if (::strcmp(key, MM_SEGMENTATION_ATTR) == 0)
+                mm_segmentation = text;
+            else if (::strcmp(key, "paint_color") == 0)
+                paint_color = text;
+        }
+        m_curr_object.geometry.triangles.emplace_back(triangle);
 
-        m_curr_object.geometry.custom_supports.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SUPPORTS_ATTR));
-        m_curr_object.geometry.custom_seam.push_back(get_attribute_value_string(attributes, num_attributes, CUSTOM_SEAM_ATTR));
+        m_curr_object.geometry.custom_supports.emplace_back(custom_supports ? custom_supports : "");
+        m_curr_object.geometry.custom_seam.emplace_back(custom_seam ? custom_seam : "");
 
         // Now load MM segmentation data. Unfortunately, BambuStudio has changed the attribute name after they forked us,
         // leading to https://github.com/prusa3d/PrusaSlicer/issues/12502. Let's try to load both keys if the usual
         // one that PrusaSlicer uses is not present.
-        std::string mm_segmentation_serialized = get_attribute_value_string(attributes, num_attributes, MM_SEGMENTATION_ATTR);
-        if (mm_segmentation_serialized.empty())
-            mm_segmentation_serialized = get_attribute_value_string(attributes, num_attributes, "paint_color");
-        m_curr_object.geometry.mm_segmentation.push_back(mm_segmentation_serialized);
+        if (mm_segmentation == nullptr || *mm_segmentation == 0)
+            mm_segmentation = paint_color;
+        m_curr_object.geometry.mm_segmentation.emplace_back(mm_segmentation ? mm_segmentation : "");
 
         return true;
     }
@@ -2624,6 +2753,40 @@ namespace Slic3r {
         typedef std::vector<BuildItem> BuildItemsList;
         typedef std::map<int, ObjectData> IdToObjectDataMap;
 
+        // Piece of the model file. Vertices and triangles are serialized and deflated in parallel.
+        struct ModelFileChunk
+        {
+            enum class Type {
+                // XML tags, compressed by the ZIP writer.
+                Text,
+                Vertices,
+                Triangles,
+            };
+
+            explicit ModelFileChunk(Type type) : type(type) {}
+
+            Type                type;
+            // Vertices or triangles <begin, end) of volume.
+            const ModelVolume  *volume { nullptr };
+            size_t              begin { 0 };
+            size_t              end { 0 };
+            // Index of the first vertex of volume in the 3MF object.
+            unsigned int        first_vertex_id { 0 };
+            // XML encoded data.
+            std::string         data;
+            // data deflated by deflate_model_file_chunk(), empty if data is to be compressed by the ZIP writer.
+            std::string         deflated;
+        };
+
+        struct ModelFileChunks
+        {
+            std::vector<ModelFileChunk> chunks;
+
+            void add_text(const std::string &text);
+            // Split vertices or triangles of a volume into chunks of EXPORT_3MF_CHUNK_SIZE.
+            void add_mesh(ModelFileChunk::Type type, const ModelVolume &volume, size_t size, unsigned int first_vertex_id);
+        };
+
         bool m_fullpath_sources{ true };
         bool m_zip64 { true };
 
@@ -2637,8 +2800,10 @@ namespace Slic3r {
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data);
-        bool _add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);        
+        bool _add_object_to_model_stream(unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets, ModelFileChunks& chunks);
+        bool _add_mesh_to_object_stream(ModelObject& object, VolumeToOffsetsMap& volumes_offsets, ModelFileChunks& chunks);
+        static void _serialize_model_file_chunk(ModelFileChunk& chunk);
+        bool _add_chunks_to_model_stream(mz_zip_writer_staged_context &context, ModelFileChunks& chunks);
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
         bool _add_cut_information_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2913,6 +3078,7 @@ namespace Slic3r {
         // all the object instances of all ModelObjects are stored and indexed in a 1 based linear fashion.
         // Therefore the list of object_ids here may not be continuous.
         unsigned int object_id = 1;
+        ModelFileChunks chunks;
         for (ModelObject* obj : model.objects) {
             if (obj == nullptr)
                 continue;
@@ -2923,13 +3089,19 @@ namespace Slic3r {
             // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
             // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(context, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
+            if (!_add_object_to_model_stream(object_id, *obj, build_items, object_it->second.volumes_offsets, chunks)) {
                 add_error("Unable to add object to archive");
                 mz_zip_writer_add_staged_finish(&context);
                 return false;
             }
         }
 
+        if (!_add_chunks_to_model_stream(context, chunks)) {
+            add_error("Unable to add model file to archive");
+            mz_zip_writer_add_staged_finish(&context);
+            return false;
+        }
+
         {
             std::stringstream stream;
             reset_stream(stream);
@@ -2956,7 +3128,7 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_object_to_model_stream(unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets, ModelFileChunks& chunks)
     {
         std::stringstream stream;
         reset_stream(stream);
@@ -2970,10 +3142,9 @@ namespace Slic3r {
             stream << "  <" << OBJECT_TAG << " id=\"" << instance_id << "\" type=\"model\">\n";
 
             if (id == 0) {
-                std::string buf = stream.str();
+                chunks.add_text(stream.str());
                 reset_stream(stream);
-                if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                    ! _add_mesh_to_object_stream(context, object, volumes_offsets)) {
+                if (! _add_mesh_to_object_stream(object, volumes_offsets, chunks)) {
                     add_error("Unable to add mesh to archive");
                     return false;
                 }
@@ -2995,8 +3166,74 @@ namespace Slic3r {
         }
 
         object_id += id;
-        std::string buf = stream.str();
-        return buf.empty() || mz_zip_writer_add_staged_data(&context, buf.data(), buf.size());
+        chunks.add_text(stream.str());
+        return true;
+    }
+
+    void _3MF_Exporter::ModelFileChunks::add_text(const std::string &text)
+    {
+        if (text.empty())
+            return;
+        if (this->chunks.empty() || this->chunks.back().type != ModelFileChunk::Type::Text)
+            this->chunks.emplace_back(ModelFileChunk::Type::Text);
+        this->chunks.back().data += text;
+    }
+
+    void _3MF_Exporter::ModelFileChunks::add_mesh(ModelFileChunk::Type type, const ModelVolume &volume, size_t size, unsigned int first_vertex_id)
+    {
+        for (size_t begin = 0; begin < size; begin += EXPORT_3MF_CHUNK_SIZE) {
+            ModelFileChunk chunk(type);
+            chunk.volume          = &volume;
+            chunk.begin           = begin;
+            chunk.end             = std::min(size, begin + EXPORT_3MF_CHUNK_SIZE);
+            chunk.first_vertex_id = first_vertex_id;
+            this->chunks.emplace_back(std::move(chunk));
+        }
+    }
+
+    bool _3MF_Exporter::_add_mesh_to_object_stream(ModelObject& object, VolumeToOffsetsMap& volumes_offsets, ModelFileChunks& chunks)
+    {
+        chunks.add_text(std::string("   <") + MESH_TAG + ">\n    <" + VERTICES_TAG + ">\n");
+
+        unsigned int vertices_count = 0;
+        for (ModelVolume* volume : object.volumes) {
+            if (volume == nullptr)
+                continue;
+
+            volumes_offsets.insert({ volume, Offsets(vertices_count) });
+
+            const indexed_triangle_set &its = volume->mesh().its;
+            if (its.vertices.empty()) {
+                add_error("Found invalid mesh");
+                return false;
+            }
+
+            chunks.add_mesh(ModelFileChunk::Type::Vertices, *volume, its.vertices.size(), vertices_count);
+            vertices_count += (int)its.vertices.size();
+        }
+
+        chunks.add_text(std::string("    </") + VERTICES_TAG + ">\n    <" + TRIANGLES_TAG + ">\n");
+
+        unsigned int triangles_count = 0;
+        for (ModelVolume* volume : object.volumes) {
+            if (volume == nullptr)
+                continue;
+
+            VolumeToOffsetsMap::iterator volume_it = volumes_offsets.find(volume);
+            assert(volume_it != volumes_offsets.end());
+
+            const indexed_triangle_set &its = volume->mesh().its;
+
+            // updates triangle offsets
+            volume_it->second.first_triangle_id = triangles_count;
+            triangles_count += (int)its.indices.size();
+            volume_it->second.last_triangle_id = triangles_count - 1;
+
+            chunks.add_mesh(ModelFileChunk::Type::Triangles, *volume, its.indices.size(), volume_it->second.first_vertex_id);
+        }
+
+        chunks.add_text(std::string("    </") + TRIANGLES_TAG + ">\n   </" + MESH_TAG + ">\n");
+        return true;
     }
 
 #if EXPORT_3MF_USE_SPIRIT_KARMA_FP
@@ -3019,28 +3256,9 @@ namespace Slic3r {
     using coordinate_type_scientific = boost::spirit::karma::real_generator<float, coordinate_policy_scientific<float>>;
 #endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
 
-    bool _3MF_Exporter::_add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
+    void _3MF_Exporter::_serialize_model_file_chunk(ModelFileChunk& chunk)
     {
-        std::string output_buffer;
-        output_buffer += "   <";
-        output_buffer += MESH_TAG;
-        output_buffer += ">\n    <";
-        output_buffer += VERTICES_TAG;
-        output_buffer += ">\n";
-
-        auto flush = [this, &output_buffer, &context](bool force = false) {
-            if ((force && ! output_buffer.empty()) || output_buffer.size() >= 65536 * 16) {
-                if (! mz_zip_writer_add_staged_data(&context, output_buffer.data(), output_buffer.size())) {
-                    add_error("Error during writing or compression");
-                    return false;
-                }
-                output_buffer.clear();
-            }
-            return true;
-        };
-
         auto format_coordinate = [](float f, char *buf) -> char* {
-            assert(is_decimal_separator_point());
 #if EXPORT_3MF_USE_SPIRIT_KARMA_FP
             // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
             // https://github.com/boostorg/spirit/pull/586
@@ -3063,31 +3281,28 @@ namespace Slic3r {
             }
             // Return pointer to the end.
             return ptr;
+#elif defined(__cpp_lib_to_chars)
+            // Round-trippable float, shortest possible, independent of locales.
+            return std::to_chars(buf, buf + 32, f).ptr;
 #else
+            assert(is_decimal_separator_point());
             // Round-trippable float, shortest possible.
             return buf + sprintf(buf, "%.9g", f);
 #endif
         };
 
-        char buf[256];
-        unsigned int vertices_count = 0;
-        for (ModelVolume* volume : object.volumes) {
-            if (volume == nullptr)
-                continue;
-
-            volumes_offsets.insert({ volume, Offsets(vertices_count) });
-
-            const indexed_triangle_set &its = volume->mesh().its;
-            if (its.vertices.empty()) {
-                add_error("Found invalid mesh");
-                return false;
-            }
-
-            vertices_count += (int)its.vertices.size();
+        assert(chunk.type != ModelFileChunk::Type::Text);
+        const ModelVolume          &volume = *chunk.volume;
+        const indexed_triangle_set &its    = volume.mesh().its;
+        std::string                &output_buffer = chunk.data;
+        // Rough estimate of the length of a vertex or a triangle without the painting data.
+        output_buffer.reserve((chunk.end - chunk.begin) * 64);
 
-            const Transform3d& matrix = volume->get_matrix();
-            for (const auto& vertex: its.vertices) {
-                Vec3f v = (matrix * vertex.cast<double>()).cast<float>();
+        char buf[256];
+        if (chunk.type == ModelFileChunk::Type::Vertices) {
+            const Transform3d& matrix = volume.get_matrix();
+            for (size_t i = chunk.begin; i < chunk.end; ++ i) {
+                Vec3f v = (matrix * its.vertices[i].cast<double>()).cast<float>();
                 char *ptr = buf;
                 boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << VERTEX_TAG << " x=\"");
                 ptr = format_coordinate(v.x(), ptr);
@@ -3096,36 +3311,11 @@ namespace Slic3r {
                 boost::spirit::karma::generate(ptr, "\" z=\"");
                 ptr = format_coordinate(v.z(), ptr);
                 boost::spirit::karma::generate(ptr, "\"/>\n");
-                *ptr = '\0';
-                output_buffer += buf;
-                if (! flush())
-                    return false;
+                output_buffer.append(buf, ptr);
             }
-        }
-
-        output_buffer += "    </";
-        output_buffer += VERTICES_TAG;
-        output_buffer += ">\n    <";
-        output_buffer += TRIANGLES_TAG;
-        output_buffer += ">\n";
-
-        unsigned int triangles_count = 0;
-        for (ModelVolume* volume : object.volumes) {
-            if (volume == nullptr)
-                continue;
-
-            bool is_left_handed = volume->is_left_handed();
-            VolumeToOffsetsMap::iterator volume_it = volumes_offsets.find(volume);
-            assert(volume_it != volumes_offsets.end());
-
-            const indexed_triangle_set &its = volume->mesh().its;
-
-            // updates triangle offsets
-            volume_it->second.first_triangle_id = triangles_count;
-            triangles_count += (int)its.indices.size();
-            volume_it->second.last_triangle_id = triangles_count - 1;
-
-            for (int i = 0; i < int(its.indices.size()); ++ i) {
+        } else {
+            bool is_left_handed = volume.is_left_handed();
+            for (int i = int(chunk.begin); i < int(chunk.end); ++ i) {
                 {
                     const Vec3i &idx = its.indices[i];
                     char *ptr = buf;
@@ -3133,14 +3323,13 @@ namespace Slic3r {
                         " v1=\"" << boost::spirit::int_ <<
                         "\" v2=\"" << boost::spirit::int_ <<
                         "\" v3=\"" << boost::spirit::int_ << "\"",
-                        idx[is_left_handed ? 2 : 0] + volume_it->second.first_vertex_id,
-                        idx[1] + volume_it->second.first_vertex_id,
-                        idx[is_left_handed ? 0 : 2] + volume_it->second.first_vertex_id);
-                    *ptr = '\0';
-                    output_buffer += buf;
+                        idx[is_left_handed ? 2 : 0] + chunk.first_vertex_id,
+                        idx[1] + chunk.first_vertex_id,
+                        idx[is_left_handed ? 0 : 2] + chunk.first_vertex_id);
+                    output_buffer.append(buf, ptr);
                 }
 
-                std::string custom_supports_data_string = volume->supported_facets.get_triangle_as_string(i);
+                std::string custom_supports_data_string = volume.supported_facets.get_triangle_as_string(i);
                 if (! custom_supports_data_string.empty()) {
                     output_buffer += " ";
                     output_buffer += CUSTOM_SUPPORTS_ATTR;
@@ -3149,7 +3338,7 @@ namespace Slic3r {
                     output_buffer += "\"";
                 }
 
-                std::string custom_seam_data_string = volume->seam_facets.get_triangle_as_string(i);
+                std::string custom_seam_data_string = volume.seam_facets.get_triangle_as_string(i);
                 if (! custom_seam_data_string.empty()) {
                     output_buffer += " ";
                     output_buffer += CUSTOM_SEAM_ATTR;
@@ -3158,7 +3347,7 @@ namespace Slic3r {
                     output_buffer += "\"";
                 }
 
-                std::string mm_painting_data_string = volume->mm_segmentation_facets.get_triangle_as_string(i);
+                std::string mm_painting_data_string = volume.mm_segmentation_facets.get_triangle_as_string(i);
                 if (! mm_painting_data_string.empty()) {
                     output_buffer += " ";
                     output_buffer += MM_SEGMENTATION_ATTR;
@@ -3168,20 +3357,62 @@ namespace Slic3r {
                 }
 
                 output_buffer += "/>\n";
-
-                if (! flush())
-                    return false;
             }
         }
+    }
 
-        output_buffer += "    </";
-        output_buffer += TRIANGLES_TAG;
-        output_buffer += ">\n   </";
-        output_buffer += MESH_TAG;
-        output_buffer += ">\n";
+    // Deflate data into a raw deflate block terminated by TDEFL_FULL_FLUSH, to be stored by mz_zip_writer_add_staged_data_deflated().
+    static bool deflate_model_file_chunk(const std::string &data, std::string &out)
+    {
+        std::unique_ptr<tdefl_compressor> compressor(new tdefl_compressor);
+        out.reserve(data.size() / 4);
+        return tdefl_init(compressor.get(), [](const void *pBuf, int len, void *pUser) -> mz_bool {
+                    static_cast<std::string*>(pUser)->append(static_cast<const char*>(pBuf), len);
+                    return MZ_TRUE;
+                }, &out, tdefl_create_comp_flags_from_zip_params(MZ_DEFAULT_LEVEL, -15, MZ_DEFAULT_STRATEGY)) == TDEFL_STATUS_OKAY &&
+            tdefl_compress_buffer(compressor.get(), data.data(), data.size(), TDEFL_FULL_FLUSH) == TDEFL_STATUS_OKAY;
+    }
 
-        // Force flush.
-        return flush(true);
+    bool _3MF_Exporter::_add_chunks_to_model_stream(mz_zip_writer_staged_context &context, ModelFileChunks& chunks)
+    {
+        // Serialize and deflate the vertices and triangles in parallel, store the chunks into the ZIP archive in order.
+        // The number of chunks in flight is limited, so that the XML encoded model file is never kept in memory as a whole.
+        std::atomic<bool> ok { true };
+        size_t            next_chunk = 0;
+        // It registers a handler that sets locales to "C" before any TBB thread starts participating in tbb::parallel_pipeline.
+        TBBLocalesSetter locales_setter;
+        tbb::parallel_pipeline(EXPORT_3MF_MAX_CHUNKS_IN_FLIGHT,
+            tbb::make_filter<void, ModelFileChunk*>(slic3r_tbb_filtermode::serial_in_order,
+                [&chunks, &next_chunk](tbb::flow_control &fc) -> ModelFileChunk* {
+                    if (next_chunk == chunks.chunks.size()) {
+                        fc.stop();
+                        return nullptr;
+                    }
+                    return &chunks.chunks[next_chunk ++];
+                }) &
+            tbb::make_filter<ModelFileChunk*, ModelFileChunk*>(slic3r_tbb_filtermode::parallel,
+                [&ok](ModelFileChunk *chunk) -> ModelFileChunk* {
+                    if (ok && chunk->type != ModelFileChunk::Type::Text) {
+                        _serialize_model_file_chunk(*chunk);
+                        if (! deflate_model_file_chunk(chunk->data, chunk->deflated))
+                            // Let the ZIP writer compress the chunk.
+                            chunk->deflated.clear();
+                    }
+                    return chunk;
+                }) &
+            tbb::make_filter<ModelFileChunk*, void>(slic3r_tbb_filtermode::serial_in_order,
+                [&context, &ok](ModelFileChunk *chunk) {
+                    if (ok && ! chunk->data.empty())
+                        ok = chunk->deflated.empty() ?
+                            mz_zip_writer_add_staged_data(&context, chunk->data.data(), chunk->data.size()) :
+                            mz_zip_writer_add_staged_data_deflated(&context, chunk->data.data(), chunk->data.size(), chunk->deflated.data(), chunk->deflated.size());
+                    // Release memory of the chunk already stored.
+                    chunk->data     = std::string();
+                    chunk->deflated = std::string();
+                }));
+        if (! ok)
+            add_error("Error during writing or compression");
+        return ok;
     }
 
     void _3MF_Exporter::add_transformation(std::stringstream &stream, const Transform3d &tr)
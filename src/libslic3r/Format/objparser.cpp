@@ -2,10 +2,15 @@
 ///|/
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <LocalesUtils.hpp>
 #include <fast_float.h>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
 #include <new>
 #include <system_error>
 #include <utility>
@@ -14,10 +19,29 @@
 #include <cstdlib>
 #include <cstring>
 
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 #include "objparser.hpp"
+#include "libslic3r/Thread.hpp"
 
 namespace ObjParser {
 
+// Size of a chunk of the OBJ file parsed at once, the chunk is extended to the next line end.
+static constexpr const size_t OBJ_CHUNK_SIZE			= 1024 * 1024;
+// Maximum number of chunks being parsed at the same time.
+static constexpr const size_t OBJ_MAX_CHUNKS_IN_FLIGHT	= 16;
+// Longer lines are considered a sign of a corrupted file.
+static constexpr const size_t OBJ_MAX_LINE_LENGTH		= 65536;
+
 // To fix issues with obj loading on macOS Sonoma, we use the following function instead of strtod that
 // was used before. Apparently the locales are not handled as they should. We already saw this before in
 // https://github.com/prusa3d/PrusaSlicer/issues/10380.
@@ -32,7 +56,10 @@ static double strtod_clocale(const char* str, char const** str_end)
 	return val;
 }
 
-static bool obj_parseline(const char *line, ObjData &data)
+// If relative_indices is not null, it receives the indices of the ObjVertex members referencing the coordinates,
+// normals and texture coordinates relative to the end of the data parsed so far: ObjVertex index * 3 + 0 for coordIdx,
+// + 1 for textureCoordIdx, + 2 for normalIdx.
+static bool obj_parseline(const char *line, ObjData &data, std::vector<size_t> *relative_indices)
 {
 #define EATWS() while (*line == ' ' || *line == '\t') ++ line
 
@@ -239,17 +266,23 @@ static bool obj_parseline(const char *line, ObjData &data)
 					line = endptr;
 				}
 			}
-			if (vertex.coordIdx < 0)
+			if (vertex.coordIdx < 0) {
                 vertex.coordIdx += (int)data.coordinates.size() / 4;
-            else
+				if (relative_indices)
+					relative_indices->emplace_back(data.vertices.size() * 3);
+			} else
 				-- vertex.coordIdx;
-			if (vertex.normalIdx < 0)
+			if (vertex.normalIdx < 0) {
                 vertex.normalIdx += (int)data.normals.size() / 3;
-            else
+				if (relative_indices)
+					relative_indices->emplace_back(data.vertices.size() * 3 + 2);
+			} else
 				-- vertex.normalIdx;
-			if (vertex.textureCoordIdx < 0)
+			if (vertex.textureCoordIdx < 0) {
                 vertex.textureCoordIdx += (int)data.textureCoordinates.size() / 3;
-            else
+				if (relative_indices)
+					relative_indices->emplace_back(data.vertices.size() * 3 + 1);
+			} else
 				-- vertex.textureCoordIdx;
 			data.vertices.push_back(vertex);
 			EATWS();
@@ -346,54 +379,144 @@ static bool obj_parseline(const char *line, ObjData &data)
 	return true;
 }
 
+// Chunk of an OBJ file parsed independently of the other chunks. The indices relative to the end of the coordinates,
+// normals or texture coordinates and the vertexIdxFirst of usemtls, objects, groups and smoothing groups are local
+// to the chunk, they are offset when the chunks are merged.
+struct ObjChunk
+{
+	const char			*begin;
+	const char			*end;
+	ObjData				 data;
+	std::vector<size_t>	 relative_indices;
+	bool				 line_too_long { false };
+};
+
+static void obj_parsechunk(ObjChunk &chunk)
+{
+	// Copy the chunk to terminate its lines with zeros.
+	std::vector<char> buf(chunk.begin, chunk.end);
+	buf.emplace_back(0);
+	size_t lastLine = 0;
+	for (size_t i = 0; i < buf.size(); ++ i)
+		if (buf[i] == '\r' || buf[i] == '\n' || i + 1 == buf.size()) {
+			if (i - lastLine > OBJ_MAX_LINE_LENGTH) {
+				chunk.line_too_long = true;
+				return;
+			}
+			buf[i] = 0;
+			char *c = buf.data() + lastLine;
+			while (*c == ' ' || *c == '\t')
+				++ c;
+			//FIXME check the return value and exit on error?
+			// Will it break parsing of some obj files?
+			obj_parseline(c, chunk.data, &chunk.relative_indices);
+			lastLine = i + 1;
+		}
+}
+
+static void obj_mergechunk(ObjChunk &chunk, ObjData &data)
+{
+	const int num_coordinates		 = int(data.coordinates.size() / 4);
+	const int num_texture_coordinates = int(data.textureCoordinates.size() / 3);
+	const int num_normals			 = int(data.normals.size() / 3);
+	const int num_vertices			 = int(data.vertices.size());
+	for (size_t idx : chunk.relative_indices) {
+		ObjVertex &vertex = chunk.data.vertices[idx / 3];
+		switch (idx % 3) {
+		case 0:  vertex.coordIdx		+= num_coordinates; break;
+		case 1:  vertex.textureCoordIdx	+= num_texture_coordinates; break;
+		default: vertex.normalIdx		+= num_normals; break;
+		}
+	}
+	auto append = [](auto &dst, auto &src) {
+		if (dst.empty())
+			dst = std::move(src);
+		else
+			dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+	};
+	auto append_offset = [num_vertices, &append](auto &dst, auto &src) {
+		for (auto &item : src)
+			item.vertexIdxFirst += num_vertices;
+		append(dst, src);
+	};
+	append(data.coordinates,		chunk.data.coordinates);
+	append(data.textureCoordinates,	chunk.data.textureCoordinates);
+	append(data.normals,			chunk.data.normals);
+	append(data.parameters,			chunk.data.parameters);
+	append(data.mtllibs,			chunk.data.mtllibs);
+	append_offset(data.usemtls,		chunk.data.usemtls);
+	append_offset(data.objects,		chunk.data.objects);
+	append_offset(data.groups,		chunk.data.groups);
+	append_offset(data.smoothingGroups, chunk.data.smoothingGroups);
+	append(data.vertices,			chunk.data.vertices);
+}
+
 bool objparse(const char *path, ObjData &data)
 {
-    Slic3r::CNumericLocalesSetter locales_setter;
+	Slic3r::CNumericLocalesSetter locales_setter;
 
-	FILE *pFile = boost::nowide::fopen(path, "rt");
-	if (pFile == 0)
+	// The file is memory mapped and split into chunks ending with a new line. The chunks are parsed in parallel
+	// and merged in order, the number of chunks in flight is limited to bound the memory of the parsed chunks.
+	boost::iostreams::mapped_file_source file;
+	try {
+		const boost::filesystem::path file_path(path);
+		if (boost::filesystem::file_size(file_path) == 0)
+			return true;
+		file.open(file_path);
+	} catch (const std::exception &) {
+		return false;
+	}
+	if (! file.is_open())
 		return false;
 
-	constexpr size_t half_buf = 65536;
+	const char			 *file_end	= file.data() + file.size();
+	const char			 *next_chunk = file.data();
+	// A chunk slot is reused by every OBJ_MAX_CHUNKS_IN_FLIGHT-th chunk, which only enters the pipeline
+	// after the chunk previously stored in that slot left the pipeline.
+	std::vector<ObjChunk> chunks(OBJ_MAX_CHUNKS_IN_FLIGHT);
+	size_t				  num_chunks = 0;
+	std::atomic<bool>	  ok { true };
 	try {
-        char buf[half_buf * 2];
-		size_t len = 0;
-		size_t lenPrev = 0;
-        while ((len = ::fread(buf + lenPrev, 1, half_buf-1, pFile)) != 0) {
-            if (std::feof(pFile)) {
-                // Fix issue with missing last trinagle in obj file:
-                // https://github.com/prusa3d/PrusaSlicer/issues/12157
-                // algorithm expect line endings after last face
-                // but file format support it
-                buf[len+lenPrev] = '\n';
-                ++len;
-            }
-			len += lenPrev;
-			size_t lastLine = 0;
-			for (size_t i = 0; i < len; ++ i)
-				if (buf[i] == '\r' || buf[i] == '\n') {
-					buf[i] = 0;
-					char *c = buf + lastLine;
-					while (*c == ' ' || *c == '\t')
-						++ c;
-					//FIXME check the return value and exit on error?
-					// Will it break parsing of some obj files?
-					obj_parseline(c, data);
-					lastLine = i + 1;
-				}
-			lenPrev = len - lastLine;
-            if (lenPrev > half_buf) {
-		    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
-				::fclose(pFile);
-				return false;
-			}
-			memmove(buf, buf + lastLine, lenPrev);
-		}
-    }
-    catch (std::bad_alloc&) {
-    	BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
+		// It registers a handler that sets locales to "C" before any TBB thread starts participating in tbb::parallel_pipeline.
+		Slic3r::TBBLocalesSetter tbb_locales_setter;
+		tbb::parallel_pipeline(OBJ_MAX_CHUNKS_IN_FLIGHT,
+			tbb::make_filter<void, ObjChunk*>(slic3r_tbb_filtermode::serial_in_order,
+				[file_end, &next_chunk, &chunks, &num_chunks, &ok](tbb::flow_control &fc) -> ObjChunk* {
+					if (! ok || next_chunk == file_end) {
+						fc.stop();
+						return nullptr;
+					}
+					// Split at the first line end after the chunk size.
+					const char *end = next_chunk + std::min<size_t>(OBJ_CHUNK_SIZE, file_end - next_chunk);
+					for (; end != file_end && *(end - 1) != '\r' && *(end - 1) != '\n'; ++ end) ;
+					ObjChunk *chunk = &chunks[num_chunks ++ % chunks.size()];
+					chunk->begin = next_chunk;
+					chunk->end   = end;
+					next_chunk   = end;
+					return chunk;
+				}) &
+			tbb::make_filter<ObjChunk*, ObjChunk*>(slic3r_tbb_filtermode::parallel,
+				[](ObjChunk *chunk) -> ObjChunk* {
+					obj_parsechunk(*chunk);
+					return chunk;
+				}) &
+			tbb::make_filter<ObjChunk*, void>(slic3r_tbb_filtermode::serial_in_order,
+				[&data, &ok](ObjChunk *chunk) {
+					if (chunk->line_too_long)
+						ok = false;
+					if (ok)
+						obj_mergechunk(*chunk, data);
+					// Release memory of the chunk already merged.
+					*chunk = ObjChunk();
+				}));
+	}
+	catch (std::bad_alloc&) {
+		BOOST_LOG_TRIVIAL(error) << "ObjParser: Out of memory";
+	}
+	if (! ok) {
+		BOOST_LOG_TRIVIAL(error) << "ObjParser: Excessive line length";
+		return false;
 	}
-	::fclose(pFile);
 
 	// printf("vertices: %d\r\n", data.vertices.size() / 4);
 	// printf("coords: %d\r\n", data.coordinates.size());
@@ -417,7 +540,7 @@ bool objparse(std::istream &stream, ObjData &data)
                     char *c = buf + lastLine;
                     while (*c == ' ' || *c == '\t')
                         ++ c;
-                    obj_parseline(c, data);
+                    obj_parseline(c, data, nullptr);
                     lastLine = i + 1;
                 }
             lenPrev = len - lastLine;
@@ -31,6 +31,7 @@
 #include "Geometry/ConvexHull.hpp"
 #include "libslic3r/GCode/LabelObjects.hpp"
 #include "libslic3r/GCode/PrintExtents.hpp"
+#include "libslic3r/GCode/PipelineStats.hpp"
 #include "libslic3r/GCode/Thumbnails.hpp"
 #include "libslic3r/GCode/WipeTower.hpp"
 #include "libslic3r/GCode/WipeTowerIntegration.hpp"
@@ -1295,7 +1296,7 @@ void GCodeGenerator::_do_export(Print& print, GCodeOutputStream &file, Thumbnail
             // and export G-code into file.
             this->process_layers(print, tool_ordering, collect_layers_to_print(object),
                 *print_object_instance_sequential_active - object.instances().data(), 
-                smooth_path_cache_global, file);
+                smooth_path_cache_global, print.m_smooth_path_layer_cache, file);
             ++ finished_objects;
             // Flag indicating whether the nozzle temperature changes from 1st to 2nd layer were performed.
             // Reset it when starting another object from 1st layer.
@@ -1359,12 +1360,14 @@ void GCodeGenerator::_do_export(Print& print, GCodeOutputStream &file, Thumbnail
         // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
         // and export G-code into file.
         this->process_layers(print, tool_ordering, print_object_instances_ordering, layers_to_print, 
-            smooth_path_cache_global, file);
+            smooth_path_cache_global, print.m_smooth_path_layer_cache, file);
         file.write(m_label_objects.maybe_stop_instance());
         if (m_wipe_tower)
             // Purge the extruder, pull out the active filament.
             file.write(m_wipe_tower->finalize(*this));
     }
+    // Keep the smooth paths of the layers of this export only for the next export.
+    print.m_smooth_path_layer_cache.release_unused();
 
     // Write end commands to file.
     file.write(this->retract_and_wipe());
@@ -1468,19 +1471,65 @@ void GCodeGenerator::_do_export(Print& print, GCodeOutputStream &file, Thumbnail
 
 // Fill in cache of smooth paths for perimeters, fills and supports of the given object layers.
 // Based on params, the paths are either decimated to sparser polylines, or interpolated with circular arches.
+// Smooth paths of layers not changed since the previous G-code export are taken from layer_cache.
 void GCodeGenerator::smooth_path_interpolate(
     const ObjectLayerToPrint                                &object_layer_to_print, 
     const GCode::SmoothPathCache::InterpolationParameters   &params, 
+    GCode::SmoothPathLayerCache                             &layer_cache,
     GCode::SmoothPathCache                                  &out)
 {
+    std::vector<const ExtrusionEntityCollection*> extrusions;
     if (const Layer *layer = object_layer_to_print.object_layer; layer) {
         for (const LayerRegion *layerm : layer->regions()) {
-            out.interpolate_add(layerm->perimeters(), params);
-            out.interpolate_add(layerm->fills(), params);
+            extrusions.emplace_back(&layerm->perimeters());
+            extrusions.emplace_back(&layerm->fills());
         }
     }
     if (const SupportLayer *layer = object_layer_to_print.support_layer; layer)
-        out.interpolate_add(layer->support_fills, params);
+        extrusions.emplace_back(&layer->support_fills);
+    layer_cache.interpolate_add(extrusions, params, out);
+}
+
+// Calculate layer data, which do not depend on the state of the G-code generator.
+// Called in parallel for multiple layers by process_layers().
+void GCodeGenerator::precalculate_layer(
+    const ObjectLayerToPrint                                &object_layer_to_print,
+    const GCode::SmoothPathCache::InterpolationParameters   &interpolation_params,
+    GCode::SmoothPathLayerCache                             &smooth_path_layer_cache,
+    const bool                                               avoid_crossing_perimeters,
+    LayerPrecalculated                                      &out)
+{
+    GCodeGenerator::smooth_path_interpolate(object_layer_to_print, interpolation_params, smooth_path_layer_cache, out.smooth_path_cache);
+    // GCodeGenerator::initialize_instance() initializes the avoid crossing perimeters with ObjectLayerToPrint::layer().
+    if (const Layer *layer = object_layer_to_print.layer(); avoid_crossing_perimeters && layer != nullptr)
+        out.avoid_crossing_perimeters_slices.emplace_back(AvoidCrossingPerimeters::make_layer_slices(*layer));
+}
+
+// Maximum number of layers in flight in the G-code export pipeline.
+static constexpr size_t process_layers_max_tokens = 12;
+
+// Cooling buffer filters of the G-code export pipeline. Only parsing of the layer G-code and applying the slow down
+// depend on the previous layers, the slow down itself is calculated for multiple layers in parallel.
+static tbb::filter<LayerResult, std::string> make_cooling_filter(CoolingBuffer &cooling_buffer, GCode::PipelineStats &stats)
+{
+    return tbb::make_filter<LayerResult, CoolingBuffer::LayerToCool>(slic3r_tbb_filtermode::serial_in_order,
+        stats.instrument<LayerResult, CoolingBuffer::LayerToCool>("cooling_parse", [&cooling_buffer](LayerResult in) -> CoolingBuffer::LayerToCool {
+            if (in.nop_layer_result) {
+                CoolingBuffer::LayerToCool out;
+                out.gcode = std::move(in.gcode);
+                return out;
+            }
+            return cooling_buffer.parse_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+        })) &
+        tbb::make_filter<CoolingBuffer::LayerToCool, CoolingBuffer::LayerToCool>(slic3r_tbb_filtermode::parallel,
+        stats.instrument<CoolingBuffer::LayerToCool, CoolingBuffer::LayerToCool>("cooling_slowdown", [&cooling_buffer](CoolingBuffer::LayerToCool in) -> CoolingBuffer::LayerToCool {
+            cooling_buffer.calculate_layer_slowdown(in);
+            return in;
+        })) &
+        tbb::make_filter<CoolingBuffer::LayerToCool, std::string>(slic3r_tbb_filtermode::serial_in_order,
+        stats.instrument<CoolingBuffer::LayerToCool, std::string>("cooling_apply", [&cooling_buffer](CoolingBuffer::LayerToCool in) -> std::string {
+            return cooling_buffer.apply_layer_cooldown(std::move(in));
+        }));
 }
 
 // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
@@ -1492,34 +1541,39 @@ void GCodeGenerator::process_layers(
     const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
     const std::vector<std::pair<coordf_t, ObjectsLayerToPrint>>         &layers_to_print,
     const GCode::SmoothPathCache                                        &smooth_path_cache_global,
+    GCode::SmoothPathLayerCache                                         &smooth_path_layer_cache,
     GCodeOutputStream                                                   &output_stream)
 {
     size_t layer_to_print_idx = 0;
+    GCode::PipelineStats stats;
     const GCode::SmoothPathCache::InterpolationParameters interpolation_params = interpolation_parameters(print.config());
-    const auto smooth_path_interpolator = tbb::make_filter<void, std::pair<size_t, GCode::SmoothPathCache>>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &layers_to_print, &layer_to_print_idx, &interpolation_params](tbb::flow_control &fc) -> std::pair<size_t, GCode::SmoothPathCache> {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    return { layer_to_print_idx ++, {} };
-                }
-            } else {
+    const bool avoid_crossing_perimeters = print.config().avoid_crossing_perimeters.value;
+    const auto layer_source = tbb::make_filter<void, LayerPrecalculated>(slic3r_tbb_filtermode::serial_in_order,
+        stats.instrument<void, LayerPrecalculated>("layer_source", [this, &print, &layers_to_print, &layer_to_print_idx](tbb::flow_control &fc) -> LayerPrecalculated {
+            // Pressure equalizer need insert empty input. Because it returns one layer back.
+            // Thus one NOP (no operation) layer is inserted after the last layer.
+            if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
+                fc.stop();
+                return {};
+            }
+            print.throw_if_canceled();
+            return { layer_to_print_idx ++ };
+        }));
+    // Layer data not depending on the state of the G-code generator are calculated in parallel
+    // for multiple layers ahead of the G-code generator.
+    const auto precalculate = tbb::make_filter<LayerPrecalculated, LayerPrecalculated>(slic3r_tbb_filtermode::parallel,
+        stats.instrument<LayerPrecalculated, LayerPrecalculated>("precalculate", [&print, &layers_to_print, &interpolation_params, &smooth_path_layer_cache, avoid_crossing_perimeters](LayerPrecalculated in) -> LayerPrecalculated {
+            if (in.layer_to_print_idx < layers_to_print.size()) {
                 print.throw_if_canceled();
-                size_t idx = layer_to_print_idx ++;
-                GCode::SmoothPathCache smooth_path_cache;
-                for (const ObjectLayerToPrint &l : layers_to_print[idx].second)
-                    GCodeGenerator::smooth_path_interpolate(l, interpolation_params, smooth_path_cache);
-                return { idx, std::move(smooth_path_cache) };
+                for (const ObjectLayerToPrint &l : layers_to_print[in.layer_to_print_idx].second)
+                    precalculate_layer(l, interpolation_params, smooth_path_layer_cache, avoid_crossing_perimeters, in);
             }
-        });
-    const auto generator = tbb::make_filter<std::pair<size_t, GCode::SmoothPathCache>, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &smooth_path_cache_global](
-            std::pair<size_t, GCode::SmoothPathCache> in) -> LayerResult {
-            size_t layer_to_print_idx = in.first;
+            return in;
+        }));
+    const auto generator = tbb::make_filter<LayerPrecalculated, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        stats.instrument<LayerPrecalculated, LayerResult>("generator", [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &smooth_path_cache_global](
+            LayerPrecalculated in) -> LayerResult {
+            size_t layer_to_print_idx = in.layer_to_print_idx;
             if (layer_to_print_idx == layers_to_print.size()) {
                 // Pressure equalizer need insert empty input. Because it returns one layer back.
                 // Insert NOP (no operation) layer;
@@ -1530,40 +1584,35 @@ void GCodeGenerator::process_layers(
                 if (m_wipe_tower && layer_tools.has_wipe_tower)
                     m_wipe_tower->next_layer();
                 print.throw_if_canceled();
+                m_avoid_crossing_perimeters.set_precalculated(std::move(in.avoid_crossing_perimeters_slices));
                 return this->process_layer(print, layer.second, layer_tools, 
-                    GCode::SmoothPathCaches{ smooth_path_cache_global, in.second }, 
+                    GCode::SmoothPathCaches{ smooth_path_cache_global, in.smooth_path_cache }, 
                     &layer == &layers_to_print.back(), &print_object_instances_ordering, size_t(-1));
             }
-        });
+        }));
     // The pipeline is variable: The vase mode filter is optional.
     const auto spiral_vase = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [spiral_vase = this->m_spiral_vase.get(), &layers_to_print](LayerResult in) -> LayerResult {
+        stats.instrument<LayerResult, LayerResult>("spiral_vase", [spiral_vase = this->m_spiral_vase.get(), &layers_to_print](LayerResult in) -> LayerResult {
             if (in.nop_layer_result)
                 return in;
             spiral_vase->enable(in.spiral_vase_enable);
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
             return { spiral_vase->process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush};
-        });
+        }));
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
+        stats.instrument<LayerResult, LayerResult>("pressure_equalizer", [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
             return pressure_equalizer->process_layer(std::move(in));
-        });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [cooling_buffer = this->m_cooling_buffer.get()](LayerResult in) -> std::string {
-             if (in.nop_layer_result)
-                return in.gcode;
-
-             return cooling_buffer->process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
-        });
+        }));
+    const auto cooling = make_cooling_filter(*this->m_cooling_buffer, stats);
     const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [find_replace = this->m_find_replace.get()](std::string s) -> std::string {
+        stats.instrument<std::string, std::string>("find_replace", [find_replace = this->m_find_replace.get()](std::string s) -> std::string {
             return find_replace->process_layer(std::move(s));
-        });
+        }));
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+        stats.instrument<std::string, void>("output", [&output_stream](std::string s) { output_stream.write(s); })
     );
 
-    tbb::filter<void, LayerResult> pipeline_to_layerresult = smooth_path_interpolator & generator;
+    tbb::filter<void, LayerResult> pipeline_to_layerresult = layer_source & precalculate & generator;
     if (m_spiral_vase)
         pipeline_to_layerresult = pipeline_to_layerresult & spiral_vase;
     if (m_pressure_equalizer)
@@ -1578,8 +1627,9 @@ void GCodeGenerator::process_layers(
     TBBLocalesSetter locales_setter;
     // The pipeline elements are joined using const references, thus no copying is performed.
     output_stream.find_replace_supress();
-    tbb::parallel_pipeline(12, pipeline_to_layerresult & pipeline_to_string & output);
+    tbb::parallel_pipeline(process_layers_max_tokens, pipeline_to_layerresult & pipeline_to_string & output);
     output_stream.find_replace_enable();
+    BOOST_LOG_TRIVIAL(info) << "G-code export pipeline statistics: " << stats.report(process_layers_max_tokens);
 }
 
 // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
@@ -1591,32 +1641,39 @@ void GCodeGenerator::process_layers(
     ObjectsLayerToPrint                      layers_to_print,
     const size_t                             single_object_idx,
     const GCode::SmoothPathCache            &smooth_path_cache_global,
+    GCode::SmoothPathLayerCache             &smooth_path_layer_cache,
     GCodeOutputStream                       &output_stream)
 {
     size_t layer_to_print_idx = 0;
+    GCode::PipelineStats stats;
     const GCode::SmoothPathCache::InterpolationParameters interpolation_params = interpolation_parameters(print.config());
-    const auto smooth_path_interpolator = tbb::make_filter<void, std::pair<size_t, GCode::SmoothPathCache>> (slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &layers_to_print, &layer_to_print_idx, interpolation_params](tbb::flow_control &fc) -> std::pair<size_t, GCode::SmoothPathCache> {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    return { layer_to_print_idx ++, {} };
-                }
-            } else {
+    const bool avoid_crossing_perimeters = print.config().avoid_crossing_perimeters.value;
+    const auto layer_source = tbb::make_filter<void, LayerPrecalculated>(slic3r_tbb_filtermode::serial_in_order,
+        stats.instrument<void, LayerPrecalculated>("layer_source", [this, &print, &layers_to_print, &layer_to_print_idx](tbb::flow_control &fc) -> LayerPrecalculated {
+            // Pressure equalizer need insert empty input. Because it returns one layer back.
+            // Thus one NOP (no operation) layer is inserted after the last layer.
+            if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
+                fc.stop();
+                return {};
+            }
+            print.throw_if_canceled();
+            return { layer_to_print_idx ++ };
+        }));
+    // Layer data not depending on the state of the G-code generator are calculated in parallel
+    // for multiple layers ahead of the G-code generator.
+    // The generator moves the processed layers out of layers_to_print, which is safe, as the precalculation
+    // only accesses the layers, which were not passed to the generator yet.
+    const auto precalculate = tbb::make_filter<LayerPrecalculated, LayerPrecalculated>(slic3r_tbb_filtermode::parallel,
+        stats.instrument<LayerPrecalculated, LayerPrecalculated>("precalculate", [&print, &layers_to_print, &interpolation_params, &smooth_path_layer_cache, avoid_crossing_perimeters](LayerPrecalculated in) -> LayerPrecalculated {
+            if (in.layer_to_print_idx < layers_to_print.size()) {
                 print.throw_if_canceled();
-                size_t idx = layer_to_print_idx ++;
-                GCode::SmoothPathCache smooth_path_cache;
-                GCodeGenerator::smooth_path_interpolate(layers_to_print[idx], interpolation_params, smooth_path_cache);
-                return { idx, std::move(smooth_path_cache) };
+                precalculate_layer(layers_to_print[in.layer_to_print_idx], interpolation_params, smooth_path_layer_cache, avoid_crossing_perimeters, in);
             }
-        });
-    const auto generator = tbb::make_filter<std::pair<size_t, GCode::SmoothPathCache>, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &smooth_path_cache_global, single_object_idx](std::pair<size_t, GCode::SmoothPathCache> in) -> LayerResult {
-            size_t layer_to_print_idx = in.first;
+            return in;
+        }));
+    const auto generator = tbb::make_filter<LayerPrecalculated, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        stats.instrument<LayerPrecalculated, LayerResult>("generator", [this, &print, &tool_ordering, &layers_to_print, &smooth_path_cache_global, single_object_idx](LayerPrecalculated in) -> LayerResult {
+            size_t layer_to_print_idx = in.layer_to_print_idx;
             if (layer_to_print_idx == layers_to_print.size()) {
                 // Pressure equalizer need insert empty input. Because it returns one layer back.
                 // Insert NOP (no operation) layer;
@@ -1624,39 +1681,35 @@ void GCodeGenerator::process_layers(
             } else {
                 ObjectLayerToPrint &layer = layers_to_print[layer_to_print_idx];
                 print.throw_if_canceled();
+                m_avoid_crossing_perimeters.set_precalculated(std::move(in.avoid_crossing_perimeters_slices));
                 return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), 
-                    GCode::SmoothPathCaches{ smooth_path_cache_global, in.second }, 
+                    GCode::SmoothPathCaches{ smooth_path_cache_global, in.smooth_path_cache }, 
                     &layer == &layers_to_print.back(), nullptr, single_object_idx);
             }
-        });
+        }));
     // The pipeline is variable: The vase mode filter is optional.
     const auto spiral_vase = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [spiral_vase = this->m_spiral_vase.get(), &layers_to_print](LayerResult in)->LayerResult {
+        stats.instrument<LayerResult, LayerResult>("spiral_vase", [spiral_vase = this->m_spiral_vase.get(), &layers_to_print](LayerResult in)->LayerResult {
             if (in.nop_layer_result)
                 return in;
             spiral_vase->enable(in.spiral_vase_enable);
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
             return { spiral_vase->process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush };
-        });
+        }));
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
+        stats.instrument<LayerResult, LayerResult>("pressure_equalizer", [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
              return pressure_equalizer->process_layer(std::move(in));
-        });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [cooling_buffer = this->m_cooling_buffer.get()](LayerResult in)->std::string {
-            if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer->process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
-        });
+        }));
+    const auto cooling = make_cooling_filter(*this->m_cooling_buffer, stats);
     const auto find_replace = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [find_replace = this->m_find_replace.get()](std::string s) -> std::string {
+        stats.instrument<std::string, std::string>("find_replace", [find_replace = this->m_find_replace.get()](std::string s) -> std::string {
             return find_replace->process_layer(std::move(s));
-        });
+        }));
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+        stats.instrument<std::string, void>("output", [&output_stream](std::string s) { output_stream.write(s); })
     );
 
-    tbb::filter<void, LayerResult> pipeline_to_layerresult = smooth_path_interpolator & generator;
+    tbb::filter<void, LayerResult> pipeline_to_layerresult = layer_source & precalculate & generator;
     if (m_spiral_vase)
         pipeline_to_layerresult = pipeline_to_layerresult & spiral_vase;
     if (m_pressure_equalizer)
@@ -1671,8 +1724,9 @@ void GCodeGenerator::process_layers(
     TBBLocalesSetter locales_setter;
     // The pipeline elements are joined using const references, thus no copying is performed.
     output_stream.find_replace_supress();
-    tbb::parallel_pipeline(12, pipeline_to_layerresult & pipeline_to_string & output);
+    tbb::parallel_pipeline(process_layers_max_tokens, pipeline_to_layerresult & pipeline_to_string & output);
     output_stream.find_replace_enable();
+    BOOST_LOG_TRIVIAL(info) << "G-code export pipeline statistics: " << stats.report(process_layers_max_tokens);
 }
 
 std::string GCodeGenerator::placeholder_parser_process(
@@ -3025,15 +3079,14 @@ void GCodeGenerator::GCodeOutputStream::close()
     }
 }
 
-void GCodeGenerator::GCodeOutputStream::write(const char *what)
+void GCodeGenerator::GCodeOutputStream::write(const std::string &what)
 {
-    if (what != nullptr) {
-        //FIXME don't allocate a string, maybe process a batch of lines?
-        std::string gcode(m_find_replace ? m_find_replace->process_layer(what) : what);
-        // writes string to file
-        fwrite(gcode.c_str(), 1, gcode.size(), this->f);
-        m_processor.process_buffer(gcode);
-    }
+    // Don't copy the G-code unless it is modified by the find-replace post-processor.
+    std::string        gcode_replaced;
+    const std::string &gcode = m_find_replace ? (gcode_replaced = m_find_replace->process_layer(what)) : what;
+    // writes string to file
+    fwrite(gcode.c_str(), 1, gcode.size(), this->f);
+    m_processor.process_buffer(gcode);
 }
 
 void GCodeGenerator::GCodeOutputStream::writeln(const std::string &what)
@@ -196,8 +196,8 @@ private:
         void close();
 
         // Write a string into a file.
-        void write(const std::string& what) { this->write(what.c_str()); }
-        void write(const char* what);
+        void write(const std::string& what);
+        void write(const char* what) { if (what != nullptr) this->write(std::string(what)); }
 
         // Write a string into a file. 
         // Add a newline, if the string does not end with a newline already.
@@ -262,6 +262,7 @@ private:
         const std::vector<const PrintInstance*>                       &print_object_instances_ordering,
         const std::vector<std::pair<coordf_t, ObjectsLayerToPrint>>   &layers_to_print,
         const GCode::SmoothPathCache                                  &smooth_path_cache_global,
+        GCode::SmoothPathLayerCache                                   &smooth_path_layer_cache,
         GCodeOutputStream                                             &output_stream);
     // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
     // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
@@ -272,6 +273,7 @@ private:
         ObjectsLayerToPrint                      layers_to_print,
         const size_t                             single_object_idx,
         const GCode::SmoothPathCache            &smooth_path_cache_global,
+        GCode::SmoothPathLayerCache             &smooth_path_layer_cache,
         GCodeOutputStream                       &output_stream);
 
     void            set_extruders(const std::vector<unsigned int> &extruder_ids);
@@ -489,7 +491,17 @@ private:
 
     // Fill in cache of smooth paths for perimeters, fills and supports of the given object layers.
     // Based on params, the paths are either decimated to sparser polylines, or interpolated with circular arches.
-    static void                         smooth_path_interpolate(const ObjectLayerToPrint &layers, const GCode::SmoothPathCache::InterpolationParameters &params, GCode::SmoothPathCache &out);
+    // Smooth paths of layers not changed since the previous G-code export are taken from layer_cache.
+    static void                         smooth_path_interpolate(const ObjectLayerToPrint &layers, const GCode::SmoothPathCache::InterpolationParameters &params, GCode::SmoothPathLayerCache &layer_cache, GCode::SmoothPathCache &out);
+
+    // Per layer data calculated by process_layers() in parallel for multiple layers ahead of the G-code generator.
+    struct LayerPrecalculated
+    {
+        size_t                                                                   layer_to_print_idx { 0 };
+        GCode::SmoothPathCache                                                   smooth_path_cache;
+        std::vector<std::shared_ptr<const AvoidCrossingPerimeters::LayerSlices>> avoid_crossing_perimeters_slices;
+    };
+    static void                         precalculate_layer(const ObjectLayerToPrint &layer, const GCode::SmoothPathCache::InterpolationParameters &params, GCode::SmoothPathLayerCache &smooth_path_layer_cache, bool avoid_crossing_perimeters, LayerPrecalculated &out);
 
     friend class GCode::Wipe;
     friend class GCode::WipeTowerIntegration;
@@ -5,6 +5,7 @@
 #ifndef slic3r_AvoidCrossingPerimeters_hpp_
 #define slic3r_AvoidCrossingPerimeters_hpp_
 
+#include <memory>
 #include <vector>
 
 #include "libslic3r/libslic3r.h"
@@ -33,6 +34,21 @@ public:
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { use_external_mp_once = false; m_disabled_once = false; }
 
+    // Part of the per layer state, which depends on the layer geometry only, not on the state of the G-code generator.
+    // It may be calculated for multiple layers in advance and in parallel, see GCodeGenerator::process_layers().
+    struct LayerSlices {
+        const Layer             *layer { nullptr };
+        // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid           grid_lslices_offset;
+    };
+    static std::shared_ptr<const LayerSlices> make_layer_slices(const Layer &layer);
+
+    // Layer slices precalculated for the layers to be printed next. init_layer() picks the matching entry
+    // instead of calculating the layer slices again.
+    void        set_precalculated(std::vector<std::shared_ptr<const LayerSlices>> &&layer_slices) { m_precalculated = std::move(layer_slices); }
     void        init_layer(const Layer &layer);
 
     Polyline    travel_to(const GCodeGenerator &gcodegen, const Point& point)
@@ -68,11 +84,9 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid           m_grid_lslices_offset;
+    // Slices of the current layer. Shared, because they may come from m_precalculated.
+    std::shared_ptr<const LayerSlices>              m_layer_slices { std::make_shared<const LayerSlices>() };
+    std::vector<std::shared_ptr<const LayerSlices>> m_precalculated;
     // Store all needed data for travels inside object
     Boundary m_internal;
     // Store all needed data for travels outside object
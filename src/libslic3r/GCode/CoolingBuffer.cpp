@@ -42,7 +42,7 @@
 
 namespace Slic3r {
 
-CoolingBuffer::CoolingBuffer(GCodeGenerator &gcodegen) : m_config(gcodegen.config()), m_toolchange_prefix(gcodegen.writer().toolchange_prefix()), m_current_extruder(0)
+CoolingBuffer::CoolingBuffer(GCodeGenerator &gcodegen) : m_config(gcodegen.config()), m_toolchange_prefix(gcodegen.writer().toolchange_prefix()), m_current_extruder(0), m_parsed_extruder(0)
 {
     this->reset(gcodegen.writer().get_position());
 
@@ -340,7 +340,19 @@ finished:
 	return new_feedrate;
 }
 
+CoolingBuffer::LayerToCool::LayerToCool() = default;
+CoolingBuffer::LayerToCool::LayerToCool(LayerToCool &&) = default;
+CoolingBuffer::LayerToCool& CoolingBuffer::LayerToCool::operator=(LayerToCool &&) = default;
+CoolingBuffer::LayerToCool::~LayerToCool() = default;
+
 std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, bool flush)
+{
+    LayerToCool layer = this->parse_layer(std::move(gcode), layer_id, flush);
+    this->calculate_layer_slowdown(layer);
+    return this->apply_layer_cooldown(std::move(layer));
+}
+
+CoolingBuffer::LayerToCool CoolingBuffer::parse_layer(std::string &&gcode, size_t layer_id, bool flush)
 {
     // Cache the input G-code.
     if (m_gcode.empty())
@@ -348,21 +360,35 @@ std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, b
     else
         m_gcode += gcode;
 
-    std::string out;
+    LayerToCool out;
     if (flush) {
         // This is either an object layer or the very last print layer. Calculate cool down over the collected support layers
         // and one object layer.
-        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_current_pos);
-        float layer_time_stretched = this->calculate_layer_slowdown(per_extruder_adjustments);
-        out = this->apply_layer_cooldown(m_gcode, layer_id, layer_time_stretched, per_extruder_adjustments);
+        out.per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_current_pos, m_parsed_extruder);
+        out.gcode                    = std::move(m_gcode);
+        out.layer_id                 = layer_id;
+        out.cool_down                = true;
         m_gcode.clear();
     }
     return out;
 }
 
+void CoolingBuffer::calculate_layer_slowdown(LayerToCool &layer) const
+{
+    if (layer.cool_down)
+        layer.layer_time = this->calculate_layer_slowdown(layer.per_extruder_adjustments);
+}
+
+std::string CoolingBuffer::apply_layer_cooldown(LayerToCool &&layer)
+{
+    return layer.cool_down ?
+        this->apply_layer_cooldown(layer.gcode, layer.layer_id, layer.layer_time, layer.per_extruder_adjustments) :
+        std::move(layer.gcode);
+}
+
 // Parse the layer G-code for the moves, which could be adjusted.
 // Return the list of parsed lines, bucketed by an extruder.
-std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::array<float, 5> &current_pos) const
+std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::array<float, 5> &current_pos, unsigned int &current_extruder) const
 {
     std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
     std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
@@ -376,7 +402,6 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
         map_extruder_to_per_extruder_adjustment[extruder_id] = i;
     }
 
-    unsigned int      current_extruder  = m_current_extruder;
     PerExtruderAdjustments *adjustment  = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
     const char       *line_start = gcode.c_str();
     const char       *line_end   = line_start;
@@ -738,7 +763,7 @@ static inline void extruder_range_slow_down_non_proportional(
 }
 
 // Calculate slow down for all the extruders.
-float CoolingBuffer::calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments)
+float CoolingBuffer::calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments) const
 {
     // Sort the extruders by an increasing slowdown_below_layer_time.
     // The layers with a lower slowdown_below_layer_time are slowed down
@@ -41,17 +41,41 @@ class CoolingBuffer {
 public:
     CoolingBuffer(GCodeGenerator &gcodegen);
     void        reset(const Vec3d &position);
-    void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; }
+    void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; m_parsed_extruder = extruder_id; }
     std::string process_layer(std::string &&gcode, size_t layer_id, bool flush);
     std::string process_layer(const std::string &gcode, size_t layer_id, bool flush)
         { return this->process_layer(std::string(gcode), layer_id, flush); }
 
+    // Layer passed between the stages of process_layer(), which may be executed by a pipeline for different layers at the same time:
+    // 1) parse_layer() is order dependent, it carries over the current position and extruder between layers.
+    // 2) calculate_layer_slowdown() only works on the layer passed, thus it may run on multiple layers in parallel.
+    // 3) apply_layer_cooldown() is order dependent, it carries over the fan speed and extruder between layers.
+    struct LayerToCool {
+        LayerToCool();
+        LayerToCool(LayerToCool &&);
+        LayerToCool& operator=(LayerToCool &&);
+        ~LayerToCool();
+
+        // G-code of the support layers collected since the last flush and of the flushed layer.
+        // Passed through unmodified if cool_down is false.
+        std::string                         gcode;
+        size_t                              layer_id { 0 };
+        // Should the layer be slowed down and the fan be controlled? False if the layer was cached to be flushed with the next layer.
+        bool                                cool_down { false };
+        std::vector<PerExtruderAdjustments> per_extruder_adjustments;
+        // Total time of this layer after slow down.
+        float                               layer_time { 0.f };
+    };
+    LayerToCool parse_layer(std::string &&gcode, size_t layer_id, bool flush);
+    void        calculate_layer_slowdown(LayerToCool &layer) const;
+    // Apply slow down over G-code lines stored in layer.per_extruder_adjustments, enable fan if needed.
+    // Returns the adjusted G-code.
+    std::string apply_layer_cooldown(LayerToCool &&layer);
+
 private:
 	CoolingBuffer& operator=(const CoolingBuffer&) = delete;
-    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, std::array<float, 5> &current_pos) const;
-    float       calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
-    // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
-    // Returns the adjusted G-code.
+    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, std::array<float, 5> &current_pos, unsigned int &current_extruder) const;
+    float       calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments) const;
     std::string apply_layer_cooldown(const std::string &gcode, size_t layer_id, float layer_time, std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
 
     // G-code snippet cached for the support layers preceding an object layer.
@@ -73,7 +97,10 @@ private:
     // Referencs GCodeGenerator::m_config, which is FullPrintConfig. While the PrintObjectConfig slice of FullPrintConfig is being modified,
     // the PrintConfig slice of FullPrintConfig is constant, thus no thread synchronization is required.
     const PrintConfig          &m_config;
+    // Extruder at the end of the last layer passed to apply_layer_cooldown().
     unsigned int                m_current_extruder;
+    // Extruder at the end of the last layer passed to parse_layer(), which may be ahead of apply_layer_cooldown().
+    unsigned int                m_parsed_extruder;
 
     // Old logic: proportional.
     bool                        m_cooling_logic_proportional = false;
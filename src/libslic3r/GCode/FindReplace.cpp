@@ -7,7 +7,11 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/find.hpp>
 #include <boost/range/iterator_range_core.hpp>
+#include <algorithm>
+#include <array>
 #include <cctype> // isalpha
+#include <cstdint>
+#include <deque>
 #include <exception>
 #include <iterator>
 #include <tuple>
@@ -35,6 +39,122 @@ const void unescape_extended_search_mode(std::string &s)
 // \u: The hexadecimal representation of a two-byte character, made of 4 digits in the 0-9, A-F/a-f range.
 }
 
+// Plain text patterns, which do not contain each other and which do not share a prefix with the other pattern's suffix.
+// Thus a match of one pattern never overlaps a match of the other and at most a single pattern ends at any position,
+// which allows for a very simple Aho-Corasick automaton: Output links are not needed and the first match reported
+// is the leftmost one.
+class GCodeFindReplace::PlainTextMatcher
+{
+public:
+    PlainTextMatcher(const Substitution *begin, const Substitution *end)
+    {
+        // Compress the alphabet: All characters not found in any pattern share the equivalence class zero.
+        m_char_class.fill(0);
+        m_num_classes = 1;
+        for (const Substitution *s = begin; s != end; ++ s)
+            for (const char c : s->plain_pattern)
+                if (m_char_class[uint8_t(c)] == 0)
+                    m_char_class[uint8_t(c)] = uint8_t(m_num_classes ++);
+
+        // Build a trie of the patterns.
+        m_transitions.assign(m_num_classes, -1);
+        m_match.assign(1, -1);
+        for (const Substitution *s = begin; s != end; ++ s) {
+            int32_t state = 0;
+            for (const char c : s->plain_pattern) {
+                int32_t &next = m_transitions[state * m_num_classes + m_char_class[uint8_t(c)]];
+                if (next == -1) {
+                    next = int32_t(m_match.size());
+                    m_match.emplace_back(-1);
+                    m_transitions.insert(m_transitions.end(), m_num_classes, -1);
+                }
+                state = m_transitions[state * m_num_classes + m_char_class[uint8_t(c)]];
+            }
+            m_match[state] = int32_t(m_patterns.size());
+            m_patterns.emplace_back(s->plain_pattern.size());
+            m_replacements.emplace_back(s->format);
+        }
+
+        // Convert the trie into a DFA by following the failure links in breadth first order.
+        std::vector<int32_t> failure(m_match.size(), 0);
+        std::deque<int32_t>  queue;
+        for (size_t c = 0; c < m_num_classes; ++ c)
+            if (int32_t &next = m_transitions[c]; next == -1)
+                next = 0;
+            else
+                queue.emplace_back(next);
+        while (! queue.empty()) {
+            int32_t state = queue.front();
+            queue.pop_front();
+            for (size_t c = 0; c < m_num_classes; ++ c) {
+                int32_t &next = m_transitions[state * m_num_classes + c];
+                int32_t  fallback = m_transitions[failure[state] * m_num_classes + c];
+                if (next == -1)
+                    next = fallback;
+                else {
+                    failure[next] = fallback;
+                    queue.emplace_back(next);
+                }
+            }
+        }
+    }
+
+    // Replace all matches of all patterns in a single pass, the result is written into out.
+    // Returns false and leaves out untouched if there was no match.
+    bool replace(const std::string &in, std::string &out) const
+    {
+        size_t  last  = 0;
+        int32_t state = 0;
+        for (size_t i = 0; i < in.size(); ++ i) {
+            state = m_transitions[state * m_num_classes + m_char_class[uint8_t(in[i])]];
+            if (int32_t idx = m_match[state]; idx != -1) {
+                size_t end   = i + 1;
+                size_t begin = end - m_patterns[idx];
+                if (last == 0)
+                    out.reserve(in.size());
+                out.append(in, last, begin - last);
+                out.append(m_replacements[idx]);
+                last  = end;
+                state = 0;
+            }
+        }
+        if (last == 0)
+            return false;
+        out.append(in, last, in.size() - last);
+        return true;
+    }
+
+private:
+    std::array<uint8_t, 256>    m_char_class;
+    size_t                      m_num_classes;
+    // DFA transitions, indexed by state * m_num_classes + character class.
+    std::vector<int32_t>        m_transitions;
+    // Index of the pattern matched when entering a state, -1 if none.
+    std::vector<int32_t>        m_match;
+    // Lengths of the patterns.
+    std::vector<size_t>         m_patterns;
+    std::vector<std::string>    m_replacements;
+};
+
+// Does a match of one string overlap with a match of the other string, if they were searched for in the same text?
+static bool strings_may_overlap(const std::string &a, const std::string &b)
+{
+    if (a.find(b) != std::string::npos || b.find(a) != std::string::npos)
+        return true;
+    // Suffix of one string equals prefix of the other string.
+    for (size_t len = 1; len < std::min(a.size(), b.size()); ++ len)
+        if (a.compare(a.size() - len, len, b, 0, len) == 0 || b.compare(b.size() - len, len, a, 0, len) == 0)
+            return true;
+    return false;
+}
+
+// Can the substitution be applied in a single pass together with other plain text substitutions?
+static bool can_merge_substitution(bool regexp, bool case_insensitive, bool whole_word, const std::string &pattern)
+{
+    // Whole word matching depends on the neighbor characters, which may be modified by the other substitutions.
+    return ! regexp && ! case_insensitive && ! whole_word && ! pattern.empty();
+}
+
 GCodeFindReplace::GCodeFindReplace(const std::vector<std::string> &gcode_substitutions)
 {
     if ((gcode_substitutions.size() % 4) != 0)
@@ -66,8 +186,31 @@ GCodeFindReplace::GCodeFindReplace(const std::vector<std::string> &gcode_substit
         }
         m_substitutions.emplace_back(std::move(out));
     }
+
+    // Merge runs of consecutive plain text substitutions into a single pass if the result does not change:
+    // The patterns must not overlap each other and the replacement strings must not overlap any pattern
+    // of the following substitutions, so that a substitution never creates or destroys a match of the next one.
+    auto mergeable = [](const Substitution &s) { return can_merge_substitution(s.regexp, s.case_insensitive, s.whole_word, s.plain_pattern); };
+    auto independent = [](const Substitution &first, const Substitution &second) {
+        return ! strings_may_overlap(first.plain_pattern, second.plain_pattern) && ! strings_may_overlap(first.format, second.plain_pattern);
+    };
+    for (size_t begin = 0; begin < m_substitutions.size();) {
+        size_t end = begin;
+        if (mergeable(m_substitutions[begin]))
+            for (++ end; end < m_substitutions.size() && mergeable(m_substitutions[end]) &&
+                std::all_of(m_substitutions.begin() + begin, m_substitutions.begin() + end,
+                    [&second = m_substitutions[end], &independent](const Substitution &first) { return independent(first, second); });
+                ++ end) ;
+        if (end - begin > 1) {
+            m_merged_substitutions.push_back({ begin, end, std::make_unique<PlainTextMatcher>(m_substitutions.data() + begin, m_substitutions.data() + end) });
+            begin = end;
+        } else
+            ++ begin;
+    }
 }
 
+GCodeFindReplace::~GCodeFindReplace() = default;
+
 class ToStringIterator 
 {
 public:
@@ -125,8 +268,19 @@ std::string GCodeFindReplace::process_layer(const std::string &ain)
     std::string temp;
     temp.reserve(in->size());
 
-    for (const Substitution &substitution : m_substitutions) {
-        if (substitution.regexp) {
+    auto merged = m_merged_substitutions.begin();
+    for (size_t idx = 0; idx < m_substitutions.size(); ++ idx) {
+        const Substitution &substitution = m_substitutions[idx];
+        if (merged != m_merged_substitutions.end() && merged->begin == idx) {
+            // Multiple plain text substitutions in a single pass.
+            temp.clear();
+            if (merged->matcher->replace(*in, temp))
+                std::swap(out, temp);
+            else if (in == &ain)
+                out = ain;
+            idx = merged->end - 1;
+            ++ merged;
+        } else if (substitution.regexp) {
             temp.clear();
             temp.reserve(in->size());
             boost::regex_replace(ToStringIterator(temp), in->begin(), in->end(),
@@ -7,6 +7,7 @@
 
 #include <boost/regex.hpp>
 #include <boost/regex/v5/regex.hpp>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -18,7 +19,7 @@ class GCodeFindReplace {
 public:
     GCodeFindReplace(const PrintConfig &print_config) : GCodeFindReplace(print_config.gcode_substitutions.values) {}
     GCodeFindReplace(const std::vector<std::string> &gcode_substitutions);
-
+    ~GCodeFindReplace();
 
     std::string process_layer(const std::string &gcode);
     
@@ -35,6 +36,18 @@ private:
         bool            single_line { false };
     };
     std::vector<Substitution> m_substitutions;
+
+    // Aho-Corasick automaton replacing several plain text patterns in a single pass.
+    class PlainTextMatcher;
+    // Run of consecutive plain text substitutions [begin, end), which do not interact with each other:
+    // Applying them in a single pass produces the same result as applying them one after the other.
+    struct MergedSubstitutions {
+        size_t                              begin;
+        size_t                              end;
+        std::unique_ptr<PlainTextMatcher>   matcher;
+    };
+    // Sorted by begin.
+    std::vector<MergedSubstitutions> m_merged_substitutions;
 };
 
 }
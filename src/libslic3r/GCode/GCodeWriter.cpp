@@ -21,10 +21,6 @@
 
 #include "libslic3r/libslic3r.h"
 
-#ifdef __APPLE__
-    #include <boost/spirit/include/karma.hpp>
-#endif
-
 #define FLAVOR_IS(val) this->config.gcode_flavor == val
 #define FLAVOR_IS_NOT(val) this->config.gcode_flavor != val
 
@@ -562,48 +558,86 @@ std::string GCodeWriter::set_fan(unsigned int speed) const
     return GCodeWriter::set_fan(this->config.gcode_flavor, this->config.gcode_comments, speed);
 }
 
-void GCodeFormatter::emit_axis(const char axis, const double v, size_t digits) {
-    assert(digits <= 9);
-    static constexpr const std::array<int, 10> pow_10{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
-    *ptr_err.ptr++ = ' '; *ptr_err.ptr++ = axis;
+// Pairs of decimal digits "00" to "99" to convert two digits at once.
+static constexpr const char digit_pairs[201] =
+    "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+    "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
 
-    char *base_ptr = this->ptr_err.ptr;
-    auto  v_int    = int64_t(std::round(v * pow_10[digits]));
-    // Older stdlib on macOS doesn't support std::from_chars at all, so it is used boost::spirit::karma::generate instead of it.
-    // That is a little bit slower than std::to_chars but not much.
-#ifdef __APPLE__
-    boost::spirit::karma::generate(this->ptr_err.ptr, boost::spirit::karma::int_generator<int64_t>(), v_int);
-#else
-    // this->buf_end minus 1 because we need space for adding the extra decimal point.
-    this->ptr_err = std::to_chars(this->ptr_err.ptr, this->buf_end - 1, v_int);
-#endif
-    size_t writen_digits = (this->ptr_err.ptr - base_ptr) - (v_int < 0 ? 1 : 0);
-    if (writen_digits < digits) {
-        // Number is smaller than 10^digits, so that we will pad it with zeros.
-        size_t remaining_digits = digits - writen_digits;
-        // Move all newly inserted chars by remaining_digits to allocate space for padding with zeros.
-        for (char *from_ptr = this->ptr_err.ptr - 1, *to_ptr = from_ptr + remaining_digits; from_ptr >= this->ptr_err.ptr - writen_digits; --to_ptr, --from_ptr)
-            *to_ptr = *from_ptr;
-
-        memset(this->ptr_err.ptr - writen_digits, '0', remaining_digits);
-        this->ptr_err.ptr += remaining_digits;
+// Write the decimal representation of v right to left, ending at ptr_end, return pointer to the first character written.
+// If min_digits is larger than the number of digits of v, v is padded with leading zeros.
+static inline char* write_uint_backwards(char *ptr_end, uint64_t v, size_t min_digits)
+{
+    char *ptr = ptr_end;
+    for (; v >= 100; v /= 100) {
+        ptr -= 2;
+        memcpy(ptr, digit_pairs + 2 * (v % 100), 2);
     }
+    if (v >= 10) {
+        ptr -= 2;
+        memcpy(ptr, digit_pairs + 2 * v, 2);
+    } else
+        *-- ptr = char('0' + v);
+    while (size_t(ptr_end - ptr) < min_digits)
+        *-- ptr = '0';
+    return ptr;
+}
+
+// Format the fixed point number v_int / 10^digits into a temporary buffer ending at ptr_end, return pointer to the first
+// character written. Trailing zeros of the fractional part are not emitted, the decimal point is omitted for integers
+// and the leading zero is omitted for numbers below one (0.5 is emitted as .5), zero is emitted as 0.
+// Templated by digits for the divisions by a power of ten to be replaced with multiplications by the compiler.
+template<size_t digits>
+static inline char* format_fixed_point(char *ptr_end, const int64_t v_int)
+{
+    static constexpr const std::array<uint64_t, 10> pow_10{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    const uint64_t v_abs     = v_int < 0 ? uint64_t(0) - uint64_t(v_int) : uint64_t(v_int);
+    const uint64_t int_part  = v_abs / pow_10[digits];
+    uint64_t       frac_part = v_abs % pow_10[digits];
+    char          *ptr       = ptr_end;
+    if (frac_part != 0) {
+        size_t frac_digits = digits;
+        for (; frac_part % 10 == 0; frac_part /= 10)
+            -- frac_digits;
+        ptr = write_uint_backwards(ptr, frac_part, frac_digits);
+        *-- ptr = '.';
+    }
+    if (int_part != 0 || frac_part == 0)
+        ptr = write_uint_backwards(ptr, int_part, 1);
+    if (v_int < 0)
+        *-- ptr = '-';
+    return ptr;
+}
 
-    // Move all newly inserted chars by one to allocate space for a decimal point.
-    for (char *to_ptr = this->ptr_err.ptr, *from_ptr = to_ptr - 1; from_ptr >= this->ptr_err.ptr - digits; --to_ptr, --from_ptr)
-        *to_ptr = *from_ptr;
+void GCodeFormatter::emit_axis(const char axis, const double v, size_t digits) {
+    assert(digits <= 9);
+    *ptr_err.ptr++ = ' '; *ptr_err.ptr++ = axis;
 
-    *(this->ptr_err.ptr - digits) = '.';
-    for (size_t i = 0; i < digits; ++i) {
-        if (*this->ptr_err.ptr != '0')
-            break;
-        this->ptr_err.ptr--;
+    [[maybe_unused]] char *base_ptr = this->ptr_err.ptr;
+    // Round half away from zero as std::round() does, without calling into the math library.
+    const double v_scaled = v * pow_10[digits];
+    auto         v_int    = int64_t(v_scaled);
+    if (const double frac = v_scaled - double(v_int); frac >= 0.5)
+        ++ v_int;
+    else if (frac <= -0.5)
+        -- v_int;
+    char       tmp[32];
+    char      *tmp_end = tmp + sizeof(tmp);
+    char      *tmp_ptr;
+    switch (digits) {
+    case 0:  tmp_ptr = format_fixed_point<0>(tmp_end, v_int); break;
+    case 1:  tmp_ptr = format_fixed_point<1>(tmp_end, v_int); break;
+    case 2:  tmp_ptr = format_fixed_point<2>(tmp_end, v_int); break;
+    case 3:  tmp_ptr = format_fixed_point<3>(tmp_end, v_int); break;
+    case 4:  tmp_ptr = format_fixed_point<4>(tmp_end, v_int); break;
+    case 5:  tmp_ptr = format_fixed_point<5>(tmp_end, v_int); break;
+    case 6:  tmp_ptr = format_fixed_point<6>(tmp_end, v_int); break;
+    case 7:  tmp_ptr = format_fixed_point<7>(tmp_end, v_int); break;
+    case 8:  tmp_ptr = format_fixed_point<8>(tmp_end, v_int); break;
+    default: tmp_ptr = format_fixed_point<9>(tmp_end, v_int); break;
     }
-    if (*this->ptr_err.ptr == '.')
-        this->ptr_err.ptr--;
-    if ((this->ptr_err.ptr + 1) == base_ptr || *this->ptr_err.ptr == '-')
-        *(++this->ptr_err.ptr) = '0';
-    this->ptr_err.ptr++;
+    assert(this->ptr_err.ptr + (tmp_end - tmp_ptr) < this->buf_end);
+    memcpy(this->ptr_err.ptr, tmp_ptr, tmp_end - tmp_ptr);
+    this->ptr_err.ptr += tmp_end - tmp_ptr;
 
 #if 0 // #ifndef NDEBUG
     {
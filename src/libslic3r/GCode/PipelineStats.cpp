@@ -0,0 +1,64 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "PipelineStats.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+namespace Slic3r {
+namespace GCode {
+
+std::string PipelineStats::report(size_t max_tokens) const
+{
+    const int64_t wall_ns = std::max<int64_t>(this->now(), 1);
+    auto ms = [](int64_t ns) { return double(ns) * 1e-6; };
+
+    // The source filter is called once more than the number of items produced, the last call stops the pipeline.
+    // Don't count the last call if the next filter received one item less.
+    auto items_produced = [this](std::deque<Stage>::const_iterator it_stage) {
+        size_t items = it_stage->items.load();
+        if (it_stage->source) {
+            auto it_next = std::find_if(std::next(it_stage), m_stages.end(), [](const Stage &stage) { return stage.items.load() > 0; });
+            if (it_next != m_stages.end() && it_next->items.load() + 1 == items)
+                -- items;
+        }
+        return items;
+    };
+
+    std::ostringstream out;
+    out.precision(6);
+    out << "{\"wall_ms\":" << ms(wall_ns) << ",\"tokens\":" << max_tokens << ",\"stages\":[";
+    auto prev = m_stages.end();
+    for (auto it_stage = m_stages.begin(); it_stage != m_stages.end(); ++ it_stage) {
+        const Stage &stage = *it_stage;
+        if (stage.items.load() == 0)
+            // Filter not used in this pipeline.
+            continue;
+        if (prev != m_stages.end())
+            out << ",";
+        const size_t  items   = items_produced(it_stage);
+        const int64_t busy_ns = stage.busy_ns.load();
+        out << "{\"name\":\"" << stage.name << "\",\"items\":" << items << ",\"bytes\":" << stage.bytes.load() <<
+            ",\"busy_ms\":" << ms(busy_ns) << ",\"utilization\":" << double(busy_ns) / double(wall_ns);
+        if (prev != m_stages.end() && ! stage.source && items_produced(prev) == items) {
+            // Each item left the previous stage once and entered this stage once, thus the total time
+            // the items waited in between is the difference of the sums of entry and exit times.
+            int64_t exit_ns_sum = prev->exit_ns_sum.load();
+            if (prev->items.load() != items)
+                // Exit time of the call of the source filter, which stopped the pipeline.
+                exit_ns_sum -= prev->last_exit_ns.load();
+            const int64_t stall_ns = std::max<int64_t>(stage.entry_ns_sum.load() - exit_ns_sum, 0);
+            out << ",\"stall_ms\":" << ms(stall_ns) << ",\"avg_queue\":" << double(stall_ns) / double(wall_ns);
+        }
+        out << "}";
+        prev = it_stage;
+    }
+    out << "]}";
+    return out.str();
+}
+
+} // namespace GCode
+} // namespace Slic3r
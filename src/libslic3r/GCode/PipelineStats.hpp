@@ -0,0 +1,127 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_GCode_PipelineStats_hpp_
+#define slic3r_GCode_PipelineStats_hpp_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace Slic3r {
+namespace GCode {
+
+// Statistics of the filters of the G-code export pipeline (see GCodeGenerator::process_layers()).
+// Filter bodies are wrapped with PipelineStats::instrument(), which measures the time spent inside the filter
+// and the time the items waited in front of the filter for the filter or for a free thread.
+// The waiting time is calculated from the sums of entry and exit times of the neighbor filters,
+// thus the items do not need to be tagged and the overhead is just a couple of atomic operations per layer.
+class PipelineStats
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PipelineStats() : m_start(Clock::now()) {}
+
+    // Wrap a body of tbb::make_filter() to collect statistics of the filter.
+    // Filters have to be instrumented in the order they are chained into the pipeline,
+    // filters not processing any item (not part of the pipeline) are ignored.
+    template<typename In, typename Out, typename Body>
+    auto instrument(const char *name, Body body)
+    {
+        Stage &stage = m_stages.emplace_back(name);
+        if constexpr (std::is_void_v<In>) {
+            // Source filter, called once more than the number of items produced to stop the pipeline.
+            // The argument is tbb::flow_control, which is not forward declarable.
+            stage.source = true;
+            return [this, &stage, body](auto &fc) -> Out {
+                const int64_t t = this->now();
+                Out out = body(fc);
+                this->leave(stage, t, item_size(out));
+                return out;
+            };
+        } else if constexpr (std::is_void_v<Out>) {
+            // Sink filter, count the bytes consumed.
+            return [this, &stage, body](In in) {
+                const int64_t t    = this->enter(stage);
+                const size_t  size = item_size(in);
+                body(std::move(in));
+                this->leave(stage, t, size);
+            };
+        } else {
+            return [this, &stage, body](In in) -> Out {
+                const int64_t t   = this->enter(stage);
+                Out           out = body(std::move(in));
+                this->leave(stage, t, item_size(out));
+                return out;
+            };
+        }
+    }
+
+    // Single line JSON report of the pipeline statistics, to be called after the pipeline finished:
+    // {"wall_ms":..,"tokens":..,"stages":[{"name":..,"items":..,"bytes":..,"busy_ms":..,"utilization":..,"stall_ms":..,"avg_queue":..},..]}
+    // busy_ms is summed over all threads, utilization is busy time relative to the wall time of the pipeline,
+    // stall_ms is the time the items waited in front of the stage after leaving the previous stage
+    // and avg_queue is the mean number of items waiting in front of the stage.
+    std::string report(size_t max_tokens) const;
+
+private:
+    struct Stage {
+        Stage(const char *name) : name(name) {}
+
+        const char             *name;
+        bool                    source { false };
+        std::atomic<size_t>     items { 0 };
+        std::atomic<size_t>     bytes { 0 };
+        std::atomic<int64_t>    busy_ns { 0 };
+        // Sums of nanoseconds since m_start, at which the items entered and left this stage.
+        std::atomic<int64_t>    entry_ns_sum { 0 };
+        std::atomic<int64_t>    exit_ns_sum { 0 };
+        // Exit time of the last item, the source filter is serial.
+        std::atomic<int64_t>    last_exit_ns { 0 };
+    };
+
+    int64_t now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count(); }
+
+    int64_t enter(Stage &stage) {
+        const int64_t t = this->now();
+        stage.entry_ns_sum.fetch_add(t, std::memory_order_relaxed);
+        return t;
+    }
+
+    void leave(Stage &stage, int64_t entered, size_t size) {
+        const int64_t t = this->now();
+        stage.items.fetch_add(1, std::memory_order_relaxed);
+        stage.bytes.fetch_add(size, std::memory_order_relaxed);
+        stage.busy_ns.fetch_add(t - entered, std::memory_order_relaxed);
+        stage.exit_ns_sum.fetch_add(t, std::memory_order_relaxed);
+        stage.last_exit_ns.store(t, std::memory_order_relaxed);
+    }
+
+    // Size of the G-code carried by a pipeline item, zero if the item does not carry G-code.
+    template<typename T, typename = void> struct has_gcode : std::false_type {};
+    template<typename T> struct has_gcode<T, std::void_t<decltype(std::declval<T>().gcode.size())>> : std::true_type {};
+    template<typename T>
+    static size_t item_size(const T &item) {
+        if constexpr (std::is_same_v<T, std::string>)
+            return item.size();
+        else if constexpr (has_gcode<T>::value)
+            return item.gcode.size();
+        else
+            return 0;
+    }
+
+    Clock::time_point   m_start;
+    // Deque for stable addresses, the filter bodies point to their stages.
+    std::deque<Stage>   m_stages;
+};
+
+} // namespace GCode
+} // namespace Slic3r
+
+#endif // slic3r_GCode_PipelineStats_hpp_
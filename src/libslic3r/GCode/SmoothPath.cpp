@@ -6,6 +6,8 @@
 #include <utility>
 #include <cassert>
 
+#include <boost/functional/hash.hpp>
+
 #include "../ExtrusionEntity.hpp"
 #include "../ExtrusionEntityCollection.hpp"
 #include "libslic3r/Geometry/ArcWelder.hpp"
@@ -120,7 +122,7 @@ void reverse(SmoothPath &path) {
         Geometry::ArcWelder::reverse(path_element.path);
 }
 
-void SmoothPathCache::interpolate_add(const ExtrusionPath &path, const InterpolationParameters &params)
+static double interpolation_tolerance(const ExtrusionPath &path, const SmoothPathCache::InterpolationParameters &params)
 {
     double tolerance = params.tolerance;
     if (path.role().is_sparse_infill())
@@ -133,7 +135,12 @@ void SmoothPathCache::interpolate_add(const ExtrusionPath &path, const Interpola
         // Brim is currently marked as skirt.
         // Use 4x lower resolution than the object fine detail for skirt & brim.
         tolerance *= 4.;
-    m_cache[&path.polyline] = Slic3r::Geometry::ArcWelder::fit_path(path.polyline.points, tolerance, params.fit_circle_tolerance);
+    return tolerance;
+}
+
+void SmoothPathCache::interpolate_add(const ExtrusionPath &path, const InterpolationParameters &params)
+{
+    m_cache[&path.polyline] = Slic3r::Geometry::ArcWelder::fit_path(path.polyline.points, interpolation_tolerance(path, params), params.fit_circle_tolerance);
 }
 
 void SmoothPathCache::interpolate_add(const ExtrusionMultiPath &multi_path, const InterpolationParameters &params)
@@ -164,6 +171,127 @@ void SmoothPathCache::interpolate_add(const ExtrusionEntityCollection &eec, cons
     }
 }
 
+// Visit the extrusion paths of a collection in the order of SmoothPathCache::interpolate_add().
+template<typename Visitor>
+static void visit_extrusion_paths(const ExtrusionEntityCollection &eec, Visitor &&visitor)
+{
+    for (const ExtrusionEntity *ee : eec) {
+        if (ee->is_collection())
+            visit_extrusion_paths(*static_cast<const ExtrusionEntityCollection*>(ee), visitor);
+        else if (const ExtrusionPath *path = dynamic_cast<const ExtrusionPath*>(ee); path)
+            visitor(*path);
+        else if (const ExtrusionMultiPath *multi_path = dynamic_cast<const ExtrusionMultiPath*>(ee); multi_path)
+            for (const ExtrusionPath &path : multi_path->paths)
+                visitor(path);
+        else if (const ExtrusionLoop *loop = dynamic_cast<const ExtrusionLoop*>(ee); loop)
+            for (const ExtrusionPath &path : loop->paths)
+                visitor(path);
+        else
+            assert(false);
+    }
+}
+
+void SmoothPathLayerCache::interpolate_add(const std::vector<const ExtrusionEntityCollection*> &layer, const SmoothPathCache::InterpolationParameters &params, SmoothPathCache &out)
+{
+    size_t hash       = 0;
+    size_t num_paths  = 0;
+    size_t num_points = 0;
+    for (const ExtrusionEntityCollection *eec : layer)
+        visit_extrusion_paths(*eec, [&params, &hash, &num_paths, &num_points](const ExtrusionPath &path) {
+            boost::hash_combine(hash, interpolation_tolerance(path, params));
+            boost::hash_combine(hash, path.polyline.size());
+            for (const Point &pt : path.polyline.points) {
+                boost::hash_combine(hash, pt.x());
+                boost::hash_combine(hash, pt.y());
+            }
+            ++ num_paths;
+            num_points += path.polyline.size();
+        });
+    if (num_paths == 0)
+        return;
+    boost::hash_combine(hash, params.fit_circle_tolerance);
+
+    // To be called with m_mutex locked.
+    auto find_cached = [this, hash, num_paths, &layer, &params]() -> std::shared_ptr<const std::vector<Geometry::ArcWelder::Path>> {
+        for (auto [it, it_end] = m_entries.equal_range(hash); it != it_end; ++ it) {
+            Entry &entry = it->second;
+            if (entry.paths.size() != num_paths || entry.fit_circle_tolerance != params.fit_circle_tolerance)
+                continue;
+            bool   match = true;
+            size_t idx   = 0;
+            for (const ExtrusionEntityCollection *eec : layer)
+                visit_extrusion_paths(*eec, [&entry, &params, &match, &idx](const ExtrusionPath &path) {
+                    match = match && entry.tolerances[idx] == interpolation_tolerance(path, params) && entry.paths[idx] == path.polyline.points;
+                    ++ idx;
+                });
+            if (match) {
+                entry.generation = m_generation;
+                return entry.smooth_paths;
+            }
+        }
+        return {};
+    };
+
+    std::shared_ptr<const std::vector<Geometry::ArcWelder::Path>> cached;
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+        cached = find_cached();
+    }
+    if (cached) {
+        // The layer did not change since a previous export, only the pointers to its extrusion paths may have.
+        auto it_smooth_path = cached->begin();
+        for (const ExtrusionEntityCollection *eec : layer)
+            visit_extrusion_paths(*eec, [&out, &it_smooth_path](const ExtrusionPath &path) {
+                out.m_cache[&path.polyline] = *it_smooth_path ++;
+            });
+        return;
+    }
+
+    // Interpolate outside of the lock.
+    Entry entry;
+    entry.paths.reserve(num_paths);
+    entry.tolerances.reserve(num_paths);
+    entry.fit_circle_tolerance = params.fit_circle_tolerance;
+    entry.num_points           = num_points;
+    auto smooth_paths = std::make_shared<std::vector<Geometry::ArcWelder::Path>>();
+    smooth_paths->reserve(num_paths);
+    for (const ExtrusionEntityCollection *eec : layer)
+        visit_extrusion_paths(*eec, [&out, &params, &entry, &smooth_paths](const ExtrusionPath &path) {
+            out.interpolate_add(path, params);
+            smooth_paths->emplace_back(*out.resolve(path));
+            entry.paths.emplace_back(path.polyline.points);
+            entry.tolerances.emplace_back(interpolation_tolerance(path, params));
+        });
+    entry.smooth_paths = std::move(smooth_paths);
+
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    if (m_num_points + num_points <= MaxPoints && ! find_cached()) {
+        entry.generation = m_generation;
+        m_entries.insert({ hash, std::move(entry) });
+        m_num_points += num_points;
+    }
+}
+
+void SmoothPathLayerCache::release_unused()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+        if (it->second.generation == m_generation)
+            ++ it;
+        else {
+            m_num_points -= it->second.num_points;
+            it = m_entries.erase(it);
+        }
+    ++ m_generation;
+}
+
+void SmoothPathLayerCache::clear()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_num_points = 0;
+}
+
 const Geometry::ArcWelder::Path* SmoothPathCache::resolve(const Polyline *pl) const
 {
     auto it = m_cache.find(pl);
@@ -2,7 +2,10 @@
 #define slic3r_GCode_SmoothPath_hpp_
 
 #include <ankerl/unordered_dense.h>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "../ExtrusionEntity.hpp"
@@ -69,6 +72,8 @@ public:
 
 private:
     ankerl::unordered_dense::map<const Polyline*, Geometry::ArcWelder::Path>    m_cache;
+
+    friend class SmoothPathLayerCache;
 };
 
 // Encapsulates references to global and layer local caches of smooth extrusion paths.
@@ -89,6 +94,45 @@ private:
     const SmoothPathCache *m_layer_local;
 };
 
+// Smooth paths of object and support layers kept between G-code exports. Re-exporting G-code after a change
+// of the G-code generator settings only (start / end G-code, custom G-code per print_z) interpolates
+// the extrusions of the unchanged layers again, which is expensive with arc fitting enabled.
+// The layers are matched by the points of their extrusion paths and by the interpolation tolerances, not by pointers,
+// as the extrusions of a re-sliced layer may be allocated at the addresses of the released ones.
+// Layers not used by an export are released once the export finished. Thread safe.
+class SmoothPathLayerCache
+{
+public:
+    // Fill in cache of smooth paths of a single layer with the extrusion collections of the layer,
+    // reusing the smooth paths of a previous export of a layer with exactly the same extrusion paths.
+    void interpolate_add(const std::vector<const ExtrusionEntityCollection*> &layer, const SmoothPathCache::InterpolationParameters &params, SmoothPathCache &out);
+
+    // To be called after a G-code export finished: Release the layers not used since the previous call.
+    void release_unused();
+    void clear();
+
+private:
+    struct Entry {
+        // Points and interpolation tolerances of the extrusion paths of the layer in the order of interpolate_add().
+        std::vector<Points>                                             paths;
+        std::vector<double>                                             tolerances;
+        double                                                          fit_circle_tolerance;
+        // Smooth paths in the order of interpolate_add().
+        std::shared_ptr<const std::vector<Geometry::ArcWelder::Path>>   smooth_paths;
+        size_t                                                          num_points;
+        // Value of m_generation of the last export, which used this layer.
+        size_t                                                          generation;
+    };
+
+    // Don't keep more than this number of input points, the layers of the largest prints are interpolated again.
+    static constexpr size_t MaxPoints = 8 * 1024 * 1024;
+
+    std::mutex                              m_mutex;
+    std::unordered_multimap<size_t, Entry>  m_entries;
+    size_t                                  m_num_points = 0;
+    size_t                                  m_generation = 0;
+};
+
 } // namespace GCode
 } // namespace Slic3r
 
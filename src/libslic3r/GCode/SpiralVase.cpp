@@ -49,11 +49,14 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
     float layer_height       = 0.f;
     float z                  = 0.f;
 
+    // The layer is parsed just once and the parsed lines are processed twice: First to measure the layer,
+    // then to modify it. The position of the reader is restored after the first pass.
+    std::vector<GCodeReader::GCodeLine> lines;
+    m_reader.parse_lines(gcode, lines);
     {
-        //FIXME Performance warning: This copies the GCodeConfig of the reader.
-        GCodeReader r = m_reader;  // clone
+        const GCodeReader::Position position = m_reader.position();
         bool set_z = false;
-        r.parse_buffer(gcode, [&total_layer_length, &layer_height, &z, &set_z]
+        m_reader.process_lines(lines, [&total_layer_length, &layer_height, &z, &set_z]
             (GCodeReader &reader, const GCodeReader::GCodeLine &line) {
             if (line.cmd_is("G1")) {
                 if (line.extruding(reader)) {
@@ -67,6 +70,7 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
                 }
             }
         });
+        m_reader.set_position(position);
     }
 
     // Remove layer height from initial Z.
@@ -86,9 +90,10 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
 
     std::string        new_gcode, transition_gcode;
     std::vector<Vec2f> current_layer;
-    m_reader.parse_buffer(gcode, [z, total_layer_length, layer_height, transition_in, transition_out, smooth_spiral, max_xy_smoothing = m_max_xy_smoothing,
-                                  &len, &last_point, &new_gcode, &transition_gcode, &current_layer, &previous_layer_distancer]
-        (GCodeReader &reader, GCodeReader::GCodeLine line) {
+    new_gcode.reserve(gcode.size());
+    m_reader.process_lines(lines, [z, total_layer_length, layer_height, transition_in, transition_out, smooth_spiral, max_xy_smoothing = m_max_xy_smoothing,
+                                   &len, &last_point, &new_gcode, &transition_gcode, &current_layer, &previous_layer_distancer]
+        (GCodeReader &reader, GCodeReader::GCodeLine &line) {
         if (line.cmd_is("G1")) {
             if (line.has_z()) {
                 // If this is the initial Z move of the layer, replace it with a
@@ -161,7 +166,8 @@ std::string SpiralVase::process_layer(const std::string &gcode, bool last_layer)
     });
 
     m_previous_layer = std::move(current_layer);
-    return new_gcode + transition_gcode;
+    new_gcode += transition_gcode;
+    return new_gcode;
 }
 
 }
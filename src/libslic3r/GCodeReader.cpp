@@ -4,8 +4,14 @@
 ///|/
 #include "GCodeReader.hpp"
 
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/nowide/cstdio.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <fast_float.h>
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <iomanip>
 #include <cassert>
@@ -26,6 +32,38 @@ static inline char get_extrusion_axis_char(const GCodeConfig &config)
     return axis.empty() ? 0 : axis[0];
 }
 
+// Parse a floating point number. Plain fixed point numbers as emitted by GCodeFormatter::emit_axis() with up to 15
+// significant digits are converted by a single division of two exactly representable doubles, which is correctly rounded
+// and thus produces the same result as fast_float. Anything else (exponents, long mantissas, inf, nan) is handed over
+// to fast_float.
+static inline const char* parse_double(const char *c, const char *end, double &v)
+{
+    static constexpr const std::array<double, 16> pow_10{ 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+    const char *p        = c;
+    const bool  negative = p != end && *p == '-';
+    if (negative)
+        ++ p;
+    uint64_t    mantissa = 0;
+    const char *digits_begin = p;
+    for (; p != end && *p >= '0' && *p <= '9'; ++ p)
+        mantissa = mantissa * 10 + uint64_t(*p - '0');
+    size_t      num_digits = p - digits_begin;
+    size_t      num_fraction_digits = 0;
+    if (p != end && *p == '.') {
+        const char *fraction_begin = ++ p;
+        for (; p != end && *p >= '0' && *p <= '9'; ++ p)
+            mantissa = mantissa * 10 + uint64_t(*p - '0');
+        num_fraction_digits = p - fraction_begin;
+        num_digits += num_fraction_digits;
+    }
+    if (num_digits == 0 || num_digits > 15 || (p != end && (*p == 'e' || *p == 'E')))
+        return fast_float::from_chars(c, end, v).ptr;
+    v = double(mantissa) / pow_10[num_fraction_digits];
+    if (negative)
+        v = - v;
+    return p;
+}
+
 void GCodeReader::apply_config(const GCodeConfig &config)
 {
     m_config = config;
@@ -38,7 +76,7 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
     m_extrusion_axis = get_extrusion_axis_char(m_config);
 }
 
-const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
+const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command) const
 {
     assert(is_decimal_separator_point());
     
@@ -75,7 +113,7 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 // Try to parse the numeric value.
                 double v;
                 c = skip_whitespaces(++ c);
-                auto [pend, ec] = fast_float::from_chars(c, end, v);
+                const char *pend = parse_double(c, end, v);
                 if (pend != c && is_end_of_word(*pend)) {
                     // The axis value has been parsed correctly.
                     if (axis != UNKNOWN_AXIS)
@@ -90,9 +128,7 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 c = skip_word(c);
         }
     }
-    
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
+
 
     // Skip the rest of the line.
     for (; ! is_end_of_line(*c); ++ c);
@@ -115,17 +151,22 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
 
 void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command)
 {
-    if (*command.first == 'G') {
-        int cmd_len = int(command.second - command.first);
-        if ((cmd_len == 2 && (command.first[1] == '0' || command.first[1] == '1')) ||
-            (cmd_len == 3 &&  command.first[1] == '9' && command.first[2] == '2')) {
-            for (size_t i = 0; i < NUM_AXES; ++ i)
-                if (gline.has(Axis(i)))
-                    m_position[i] = gline.value(Axis(i));
-        }
+    if (cmd_updates_coordinates(std::string_view(command.first, command.second - command.first))) {
+        for (size_t i = 0; i < NUM_AXES; ++ i)
+            if (gline.has(Axis(i)))
+                m_position[i] = gline.value(Axis(i));
     }
 }
 
+void GCodeReader::parse_lines(const std::string &buffer, std::vector<GCodeLine> &lines) const
+{
+    const char *ptr = buffer.c_str();
+    const char *end = ptr + buffer.size();
+    std::pair<const char*, const char*> cmd;
+    while (*ptr != 0)
+        ptr = this->parse_line_internal(ptr, end, lines.emplace_back(), cmd);
+}
+
 template<typename ParseLineCallback, typename LineEndCallback>
 bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback)
 {
@@ -189,16 +230,105 @@ bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLine
     return true;
 }
 
+// Tokenize the lines of a memory mapped chunk of a G-code file. The chunk has to end with a '\n' character,
+// so that parse_line_internal() never reads past its end. Lines are split the same way parse_file_raw_internal() does.
+void GCodeReader::parse_chunk(const char *begin, const char *end, size_t file_pos, std::vector<GCodeLine> &lines, std::vector<size_t> &lines_ends) const
+{
+    assert(begin == end || *(end - 1) == '\n');
+    std::pair<const char*, const char*> cmd;
+    for (const char *it = begin; it != end;) {
+        // Find end of line.
+        const char *it_end = it;
+        for (; *it_end != '\r' && *it_end != '\n'; ++ it_end);
+        GCodeLine &gline = lines.emplace_back();
+        if (it != it_end)
+            this->parse_line_internal(it, it_end, gline, cmd);
+        // Skip EOL.
+        it = it_end;
+        if (*it == '\r')
+            ++ it;
+        if (it != end && *it == '\n')
+            lines_ends.emplace_back(file_pos + (++ it - begin));
+    }
+}
+
 template<typename ParseLineCallback, typename LineEndCallback>
 bool GCodeReader::parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback)
 {
-    GCodeLine gline;    
-    return this->parse_file_raw_internal(filename, 
-        [this, &gline, parse_line_callback](const char *begin, const char *end) {
-            gline.reset();
-            this->parse_line(begin, end, gline, parse_line_callback);
-        }, 
-        line_end_callback);
+    // The file is memory mapped and split into chunks ending with a new line. The chunks of a batch are tokenized
+    // in parallel, then the lines are interpreted serially as the position of the reader depends on the previous lines.
+    static constexpr const size_t chunk_size      = 1024 * 1024;
+    static constexpr const size_t chunks_in_batch = 16;
+
+    boost::iostreams::mapped_file_source file;
+    try {
+        const boost::filesystem::path path(filename);
+        if (boost::filesystem::file_size(path) == 0)
+            return true;
+        file.open(path);
+    } catch (const std::exception &) {
+        return false;
+    }
+    if (! file.is_open())
+        return false;
+
+    const char  *data      = file.data();
+    const size_t file_size = file.size();
+    // The tail of the file not terminated by '\n' is copied and terminated, so that the tokenizer
+    // does not need to test for the end of the mapped memory.
+    size_t       mapped_size = file_size;
+    for (; mapped_size > 0 && data[mapped_size - 1] != '\n'; -- mapped_size);
+    const std::string tail = std::string(data + mapped_size, data + file_size) + "\n";
+
+    struct Chunk {
+        size_t                 begin;
+        size_t                 end;
+        std::vector<GCodeLine> lines;
+        std::vector<size_t>    lines_ends;
+    };
+    std::vector<Chunk> chunks(chunks_in_batch);
+
+    m_parsing = true;
+    for (size_t file_pos = 0; file_pos < mapped_size;) {
+        // Split the next batch into chunks aligned to line ends.
+        size_t num_chunks = 0;
+        for (; num_chunks < chunks_in_batch && file_pos < mapped_size; ++ num_chunks) {
+            Chunk &chunk = chunks[num_chunks];
+            chunk.begin = file_pos;
+            chunk.end   = std::min(file_pos + chunk_size, mapped_size);
+            if (const void *eol = memchr(data + chunk.end - 1, '\n', mapped_size - chunk.end + 1); eol)
+                chunk.end = static_cast<const char*>(eol) - data + 1;
+            file_pos = chunk.end;
+        }
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1), [this, data, &chunks](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                Chunk &chunk = chunks[i];
+                chunk.lines.clear();
+                chunk.lines_ends.clear();
+                this->parse_chunk(data + chunk.begin, data + chunk.end, chunk.begin, chunk.lines, chunk.lines_ends);
+            }
+        });
+        for (size_t i = 0; i < num_chunks; ++ i) {
+            Chunk &chunk = chunks[i];
+            for (size_t line_end : chunk.lines_ends)
+                line_end_callback(line_end);
+            this->process_lines(chunk.lines, parse_line_callback);
+            if (! m_parsing)
+                // The callback wishes to exit.
+                return true;
+        }
+        if (m_progress_callback != nullptr)
+            m_progress_callback(static_cast<float>(file_pos) / static_cast<float>(file_size));
+    }
+
+    if (tail.size() > 1) {
+        std::vector<GCodeLine> lines;
+        std::vector<size_t>    lines_ends;
+        // The only line end of the tail is the one appended above, it is not reported to line_end_callback.
+        this->parse_chunk(tail.data(), tail.data() + tail.size(), mapped_size, lines, lines_ends);
+        this->process_lines(lines, parse_line_callback);
+    }
+    return true;
 }
 
 bool GCodeReader::parse_file(const std::string &file, callback_t callback)
@@ -260,7 +390,7 @@ bool GCodeReader::GCodeLine::has_value(std::string_view axis_pos, float &value)
         // Try to parse the numeric value.
         double v = 0.;
         const char *end = axis_pos.data() + axis_pos.size();
-        auto [pend, ec] = fast_float::from_chars(++ c, end, v);
+        const char *pend = parse_double(++ c, end, v);
         if (pend != c && is_end_of_word(*pend)) {
             // The axis value has been parsed correctly.
             value = float(v);
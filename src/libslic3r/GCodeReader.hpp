@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <array>
 #include <cmath>
 #include <cstdlib>
 #include <functional>
@@ -137,11 +138,37 @@ public:
     {
         std::pair<const char*, const char*> cmd;
         const char *line_end = parse_line_internal(ptr, end, gline, cmd);
+        this->reset_relative_e(gline);
         callback(*this, gline);
         update_coordinates(gline, cmd);
         return line_end;
     }
 
+    // Parse the buffer into lines without calling any callback and without updating the position of the reader.
+    // The lines may then be processed multiple times by process_lines() without parsing the G-code again.
+    void parse_lines(const std::string &buffer, std::vector<GCodeLine> &lines) const;
+
+    // Call the callback for lines parsed by parse_lines() and update the position of the reader the same way
+    // parse_buffer() does. The callback may modify the lines, the reader follows the positions as they were parsed.
+    template<typename Callback>
+    void process_lines(std::vector<GCodeLine> &lines, Callback callback)
+    {
+        m_parsing = true;
+        for (auto it = lines.begin(); m_parsing && it != lines.end(); ++ it) {
+            GCodeLine &gline = *it;
+            this->reset_relative_e(gline);
+            const bool     update = cmd_updates_coordinates(gline.cmd());
+            const uint32_t mask   = gline.m_mask;
+            float          axis[NUM_AXES];
+            memcpy(axis, gline.m_axis, sizeof(axis));
+            callback(*this, gline);
+            if (update)
+                for (size_t i = 0; i < NUM_AXES; ++ i)
+                    if (mask & (1 << i))
+                        m_position[i] = axis[i];
+        }
+    }
+
     template<typename Callback>
     void parse_line(const std::string &line, Callback callback)
         { GCodeLine gline; this->parse_line(line.c_str(), line.c_str() + line.size(), gline, callback); }
@@ -169,6 +196,11 @@ public:
     float  f() const { return m_position[F]; }
     Point  xy_scaled() const { return Point::new_scale(this->x(), this->y()); }
 
+    // Position of all axes, to be saved and restored when processing the same lines multiple times.
+    using Position = std::array<float, NUM_AXES>;
+    Position position() const { Position out; std::copy(std::begin(m_position), std::end(m_position), out.begin()); return out; }
+    void     set_position(const Position &position) { std::copy(position.begin(), position.end(), std::begin(m_position)); }
+
 
     // Returns 0 for gcfNoExtrusion.
     char   extrusion_axis() const { return m_extrusion_axis; }
@@ -182,8 +214,15 @@ private:
     template<typename ParseLineCallback, typename LineEndCallback>
     bool        parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
 
-    const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
+    const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command) const;
+    void        parse_chunk(const char *begin, const char *end, size_t file_pos, std::vector<GCodeLine> &lines, std::vector<size_t> &lines_ends) const;
     void        update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command);
+    void        reset_relative_e(const GCodeLine &gline) {
+        if (gline.has(E) && m_config.use_relative_e_distances)
+            m_position[E] = 0;
+    }
+    // G0, G1 and G92 update the position of the reader.
+    static bool cmd_updates_coordinates(std::string_view cmd) { return cmd == "G0" || cmd == "G1" || cmd == "G92"; }
 
     static bool         is_whitespace(char c)           { return c == ' ' || c == '\t'; }
     static bool         is_end_of_line(char c)          { return c == '\r' || c == '\n' || c == 0; }
@@ -220,7 +220,8 @@ public:
         for (const LayerRegion *layerm : m_regions) if (layerm->slices().any_bottom_contains(item)) return true;
         return false;
     }
-    void                    make_perimeters();
+    // Arachne toolpaths are reused from wall_tool_paths_cache if provided.
+    void                    make_perimeters(Arachne::WallToolPathsCache *wall_tool_paths_cache = nullptr);
     void                    make_fills(FillAdaptive::Octree     *adaptive_fill_octree,
                                        FillAdaptive::Octree     *support_fill_octree,
                                        FillLightning::Generator *lightning_generator);
@@ -95,7 +95,9 @@ void LayerRegion::make_perimeters(
     // All fill areas produced for all input slices above.
     ExPolygons                                             &fill_expolygons,
     // Ranges of fill areas above per input slice.
-    std::vector<ExPolygonRange>                            &fill_expolygons_ranges)
+    std::vector<ExPolygonRange>                            &fill_expolygons_ranges,
+    // Optional cache of Arachne toolpaths shared between layers and objects.
+    Arachne::WallToolPathsCache                            *wall_tool_paths_cache)
 {
     m_perimeters.clear();
     m_thin_fills.clear();
@@ -144,6 +146,7 @@ void LayerRegion::make_perimeters(
                 lower_slices,
                 upper_slices,
                 lower_layer_polygons_cache,
+                wall_tool_paths_cache,
                 // output:
                 m_perimeters,
                 m_thin_fills,
@@ -29,6 +29,10 @@ class PrintObject;
 using LayerPtrs = std::vector<Layer*>;
 class PrintRegion;
 
+namespace Arachne {
+class WallToolPathsCache;
+} // namespace Arachne
+
 // Range of indices, providing support for range based loops.
 template<typename T>
 class IndexRange
@@ -125,7 +129,9 @@ public:
         // All fill areas produced for all input slices above.
         ExPolygons                                             &fill_expolygons,
         // Ranges of fill areas above per input slice.
-        std::vector<ExPolygonRange>                            &fill_expolygons_ranges);
+        std::vector<ExPolygonRange>                            &fill_expolygons_ranges,
+        // Optional cache of Arachne toolpaths shared between layers and objects.
+        Arachne::WallToolPathsCache                            *wall_tool_paths_cache);
     void    process_external_surfaces(const Layer *lower_layer, const Polygons *lower_layer_covered);
     double  infill_area_threshold() const;
     // Trim surfaces by trimming polygons. Used by the elephant foot compensation at the 1st layer.
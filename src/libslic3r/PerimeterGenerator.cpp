@@ -1055,6 +1055,21 @@ std::tuple<std::vector<ExtrusionPaths>, Polygons> generate_extra_perimeters_over
     return {extra_perims, diff(inset_overhang_area, inset_overhang_area_left_unfilled)};
 }
 
+// Arachne toolpaths and their inner contour. If the cache is provided, the result of another layer or object with exactly the same outline is reused.
+static std::pair<Arachne::Perimeters, Polygons> generate_arachne_wall_tool_paths(
+    const PerimeterGenerator::Parameters &params, const Polygons &outline, coord_t bead_width_0, coord_t bead_width_x, size_t inset_count,
+    Arachne::WallToolPathsCache *wall_tool_paths_cache)
+{
+    if (wall_tool_paths_cache != nullptr) {
+        Arachne::WallToolPathsCache::ResultPtr result = wall_tool_paths_cache->generate(outline, bead_width_0, bead_width_x, inset_count, 0, params.layer_height, params.object_config, params.print_config);
+        return { result->toolpaths, result->inner_contour };
+    }
+
+    Arachne::WallToolPaths wall_tool_paths(outline, bead_width_0, bead_width_x, inset_count, 0, params.layer_height, params.object_config, params.print_config);
+    Arachne::Perimeters    perimeters = wall_tool_paths.getToolPaths();
+    return { std::move(perimeters), wall_tool_paths.getInnerContour() };
+}
+
 // Thanks, Cura developers, for implementing an algorithm for generating perimeters with variable width (Arachne) that is based on the paper
 // "A framework for adaptive width control of dense contour-parallel toolpaths in fused deposition modeling"
 void PerimeterGenerator::process_arachne(
@@ -1065,6 +1080,7 @@ void PerimeterGenerator::process_arachne(
     const ExPolygons           *upper_slices,
     // Cache:
     Polygons                   &lower_slices_polygons_cache,
+    Arachne::WallToolPathsCache *wall_tool_paths_cache,
     // Output:
     // Loops with the external thin walls
     ExtrusionEntityCollection  &out_loops,
@@ -1108,9 +1124,8 @@ void PerimeterGenerator::process_arachne(
 
     ExPolygons last   = offset_ex(surface.expolygon.simplify_p(params.scaled_resolution), - float(ext_perimeter_width / 2. - ext_perimeter_spacing / 2.));
     Polygons   last_p = to_polygons(last);
-    Arachne::WallToolPaths wall_tool_paths(last_p, ext_perimeter_spacing, perimeter_spacing, coord_t(loop_number + 1), 0, params.layer_height, params.object_config, params.print_config);
-    Arachne::Perimeters    perimeters     = wall_tool_paths.getToolPaths();
-    ExPolygons             infill_contour = union_ex(wall_tool_paths.getInnerContour());
+    auto [perimeters, inner_contour] = generate_arachne_wall_tool_paths(params, last_p, ext_perimeter_spacing, perimeter_spacing, size_t(loop_number + 1), wall_tool_paths_cache);
+    ExPolygons infill_contour        = union_ex(inner_contour);
 
     // Check if there are some remaining perimeters to generate (the number of perimeters
     // is greater than one together with enabled the single perimeter on top surface feature).
@@ -1146,8 +1161,7 @@ void PerimeterGenerator::process_arachne(
             top_expolygons = intersection_ex(top_expolygons, infill_contour);
 
             const Polygons not_top_polygons = to_polygons(not_top_expolygons);
-            Arachne::WallToolPaths inner_wall_tool_paths(not_top_polygons, perimeter_spacing, perimeter_spacing, coord_t(inner_loop_number + 1), 0, params.layer_height, params.object_config, params.print_config);
-            Arachne::Perimeters inner_perimeters = inner_wall_tool_paths.getToolPaths();
+            auto [inner_perimeters, inner_wall_contour] = generate_arachne_wall_tool_paths(params, not_top_polygons, perimeter_spacing, perimeter_spacing, size_t(inner_loop_number + 1), wall_tool_paths_cache);
 
             // Recalculate indexes of inner perimeters before merging them.
             if (!perimeters.empty()) {
@@ -1161,13 +1175,12 @@ void PerimeterGenerator::process_arachne(
             }
 
             perimeters.insert(perimeters.end(), inner_perimeters.begin(), inner_perimeters.end());
-            infill_contour = union_ex(top_expolygons, inner_wall_tool_paths.getInnerContour());
+            infill_contour = union_ex(top_expolygons, inner_wall_contour);
         } else {
             // There is no top surface ExPolygon, so we call Arachne again with parameters
             // like when the single perimeter feature is disabled.
-            Arachne::WallToolPaths no_single_perimeter_tool_paths(last_p, ext_perimeter_spacing, perimeter_spacing, coord_t(inner_loop_number + 2), 0, params.layer_height, params.object_config, params.print_config);
-            perimeters     = no_single_perimeter_tool_paths.getToolPaths();
-            infill_contour = union_ex(no_single_perimeter_tool_paths.getInnerContour());
+            std::tie(perimeters, inner_contour) = generate_arachne_wall_tool_paths(params, last_p, ext_perimeter_spacing, perimeter_spacing, size_t(inner_loop_number + 2), wall_tool_paths_cache);
+            infill_contour = union_ex(inner_contour);
         }
     }
 
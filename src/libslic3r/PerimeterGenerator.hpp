@@ -25,6 +25,10 @@ class ExtrusionEntityCollection;
 class Surface;
 struct ThickPolyline;
 
+namespace Arachne {
+class WallToolPathsCache;
+} // namespace Arachne
+
 namespace PerimeterGenerator
 {
 
@@ -103,6 +107,8 @@ void process_arachne(
     const ExPolygons           *upper_slices,
     // Cache:
     Polygons                   &lower_slices_polygons_cache,
+    // Optional, shared between layers and objects.
+    Arachne::WallToolPathsCache *wall_tool_paths_cache,
     // Output:
     // Loops with the external thin walls
     ExtrusionEntityCollection  &out_loops,
@@ -7,14 +7,18 @@
 #include <cassert>
 
 #include "libslic3r.h"
+#include "libslic3r_version.h"
 #include "PresetBundle.hpp"
 #include "Utils.hpp"
 #include "Model.hpp"
 #include "format.hpp"
 
 #include <algorithm>
+#include <ctime>
+#include <iterator>
 #include <set>
 #include <fstream>
+#include <sstream>
 #include <unordered_set>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/clamp.hpp>
@@ -27,6 +31,12 @@
 #include <boost/locale.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <miniz.h>
+
 #include <LibBGCode/core/core.hpp>
 
 // Store the print/filament/printer presets into a "presets" subdirectory of the Slic3rPE config dir.
@@ -369,13 +379,13 @@ std::pair<PresetsConfigSubstitutions, std::string> PresetBundle::load_system_pre
                 // Load the config bundle, flatten it.
                 if (first) {
                     // Reset this PresetBundle and load the first vendor config.
-                    append(substitutions, this->load_configbundle(dir_entry.path().string(), PresetBundle::LoadSystem, compatibility_rule).first);
+                    append(substitutions, this->load_configbundle(dir_entry.path().string(), PresetBundle::LoadSystem | PresetBundle::UseCache, compatibility_rule).first);
                     first = false;
                 } else {
                     // Load the other vendor configs, merge them with this PresetBundle.
                     // Report duplicate profiles.
                     PresetBundle other;
-                    append(substitutions, other.load_configbundle(dir_entry.path().string(), PresetBundle::LoadSystem, compatibility_rule).first);
+                    append(substitutions, other.load_configbundle(dir_entry.path().string(), PresetBundle::LoadSystem | PresetBundle::UseCache, compatibility_rule).first);
                     std::vector<std::string> duplicates = this->merge_presets(std::move(other));
                     if (! duplicates.empty()) {
                         errors_cummulative += "Vendor configuration file " + name + " contains the following presets with names used by other vendors: ";
@@ -1405,6 +1415,131 @@ static void flatten_configbundle_hierarchy(boost::property_tree::ptree &tree, co
     flatten_configbundle_hierarchy(tree, "printer",         preset_bundle ? preset_bundle->printers.system_preset_names()      : std::vector<std::string>());
 }
 
+// Version of the binary cache of a system config bundle. Increase when changing the layout of ConfigBundleCache.
+static constexpr const int CONFIG_BUNDLE_CACHE_VERSION = 2;
+
+// System presets of a vendor config bundle as loaded by PresetBundle::load_configbundle(), stored in a binary cache.
+// Reading, flattening and deserializing a large config bundle takes a considerable time on every start of the application,
+// while loading the resolved preset configs through cereal is an order of magnitude faster.
+// The cache file contains the key, CRC32 of the payload and the payload, which is the binary archive of the sections and presets.
+// The payload is only deserialized if its CRC32 matches, thus a truncated or otherwise damaged cache is never parsed.
+struct ConfigBundleCache
+{
+    struct CachedPreset {
+        int                         type;
+        std::string                 name;
+        std::string                 alias;
+        std::vector<std::string>    renamed_from;
+        DynamicPrintConfig          config;
+
+        template<class Archive> void serialize(Archive &ar) { ar(type, name, alias, renamed_from, config); }
+    };
+
+    // Identifies the config bundle, its content and the application build the cache was created by.
+    std::string                 key;
+    // Sections of the config bundle other than the presets (vendor profile, printer models, obsolete presets) in the INI format.
+    std::string                 sections;
+    // Presets in the order they were loaded.
+    std::vector<CachedPreset>   presets;
+};
+
+static uint32_t config_bundle_cache_crc32(const std::string &payload)
+{
+    return uint32_t(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(payload.data()), payload.size()));
+}
+
+static boost::filesystem::path config_bundle_cache_path(const std::string &path)
+{
+    return (boost::filesystem::path(data_dir()) / "cache" / "presets" / (boost::filesystem::path(path).stem().string() + ".bin")).make_preferred();
+}
+
+static std::string config_bundle_cache_key(const std::string &path, const std::string &data)
+{
+    // The cache is invalidated by a change of the print config definition, which modifies the serialization key ordinals.
+    static const std::string config_def_hash = []() {
+        std::string keys;
+        for (const auto &[ordinal, def] : print_config_def.by_serialization_key_ordinal)
+            keys += std::to_string(ordinal) + ":" + def->opt_key + ":" + std::to_string(int(def->type)) + ";";
+        return std::to_string(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(keys.data()), keys.size()));
+    }();
+    boost::system::error_code ec;
+    const std::time_t mtime = boost::filesystem::last_write_time(path, ec);
+    return format("%1% %2% %3% %4%\n%5%\n%6% %7% %8%", CONFIG_BUNDLE_CACHE_VERSION, SLIC3R_VERSION, SLIC3R_BUILD_ID, config_def_hash,
+        path, data.size(), int64_t(mtime), mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(data.data()), data.size()));
+}
+
+static bool load_config_bundle_cache(const std::string &path, const std::string &key, ConfigBundleCache &cache)
+{
+    const boost::filesystem::path cache_path = config_bundle_cache_path(path);
+    try {
+        if (! boost::filesystem::exists(cache_path))
+            return false;
+        boost::nowide::ifstream ifs(cache_path.string(), std::ios::binary);
+        cereal::BinaryInputArchive archive(ifs);
+        // Read the key first to skip an outdated cache quickly.
+        archive(cache.key);
+        if (cache.key != key)
+            return false;
+        uint32_t    crc32;
+        std::string payload;
+        archive(crc32, payload);
+        if (crc32 != config_bundle_cache_crc32(payload))
+            throw Slic3r::RuntimeError("CRC32 mismatch");
+        std::istringstream          iss(std::move(payload));
+        cereal::BinaryInputArchive  payload_archive(iss);
+        payload_archive(cache.sections, cache.presets);
+    } catch (const std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << "Failed loading config bundle cache " << cache_path.string() << ": " << err.what();
+        return false;
+    }
+    BOOST_LOG_TRIVIAL(debug) << "Loaded config bundle " << path << " from cache " << cache_path.string();
+    return true;
+}
+
+static void save_config_bundle_cache(const std::string &path, const ConfigBundleCache &cache)
+{
+    // Several instances may be started at the same time, thus the cache is written into a temporary file first, then renamed.
+    const boost::filesystem::path cache_path = config_bundle_cache_path(path);
+    const boost::filesystem::path temp_path  = cache_path.parent_path() / boost::filesystem::unique_path(cache_path.filename().string() + ".%%%%-%%%%-%%%%");
+    try {
+        std::string payload;
+        {
+            std::ostringstream          oss;
+            cereal::BinaryOutputArchive payload_archive(oss);
+            payload_archive(cache.sections, cache.presets);
+            payload = oss.str();
+        }
+        boost::filesystem::create_directories(cache_path.parent_path());
+        {
+            boost::nowide::ofstream ofs(temp_path.string(), std::ios::binary);
+            cereal::BinaryOutputArchive archive(ofs);
+            archive(cache.key, config_bundle_cache_crc32(payload), payload);
+            ofs.close();
+            if (ofs.fail())
+                throw Slic3r::RuntimeError("Write failed");
+        }
+        boost::filesystem::rename(temp_path, cache_path);
+    } catch (const std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << "Failed saving config bundle cache " << cache_path.string() << ": " << err.what();
+        boost::system::error_code ec;
+        boost::filesystem::remove(temp_path, ec);
+    }
+}
+
+// Path of a preset file loaded from a config bundle.
+static boost::filesystem::path config_bundle_preset_path(const std::string &section_name, const std::string &preset_name)
+{
+    auto file_name = boost::algorithm::iends_with(preset_name, ".ini") ? preset_name : preset_name + ".ini";
+    return (boost::filesystem::path(data_dir()) 
+#ifdef SLIC3R_PROFILE_USE_PRESETS_SUBDIR
+        // Store the print/filament/printer presets into a "presets" directory.
+        / "presets" 
+#else
+        // Store the print/filament/printer presets at the same location as the upstream Slic3r.
+#endif
+        / section_name / file_name).make_preferred();
+}
+
 // Load a config bundle file, into presets and store the loaded presets into separate files
 // of the local configuration directory.
 std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
@@ -1421,14 +1556,30 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
     // 1) Read the complete config file into a boost::property_tree.
     namespace pt = boost::property_tree;
     pt::ptree tree;
+    std::string data;
     {
         boost::nowide::ifstream ifs(path);
-        try {
-            pt::read_ini(ifs, tree);
-        } catch (const boost::property_tree::ini_parser::ini_parser_error &err) {
-            throw Slic3r::RuntimeError(format("Failed loading config bundle \"%1%\"\nError: \"%2%\" at line %3%", path, err.message(), err.line()).c_str());
+        data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    // System presets are loaded from the binary cache if it was created from the very same config bundle,
+    // otherwise the cache is rebuilt. Only the sections other than the presets are parsed from the cache.
+    const bool        use_cache    = flags.has(LoadConfigBundleAttribute::LoadSystem) && flags.has(LoadConfigBundleAttribute::UseCache);
+    ConfigBundleCache cache;
+    bool              cache_loaded = false;
+    if (use_cache) {
+        std::string key = config_bundle_cache_key(path, data);
+        cache_loaded = load_config_bundle_cache(path, key, cache);
+        if (! cache_loaded) {
+            cache = ConfigBundleCache();
+            cache.key = std::move(key);
         }
     }
+    try {
+        std::istringstream iss(cache_loaded ? cache.sections : data);
+        pt::read_ini(iss, tree);
+    } catch (const boost::property_tree::ini_parser::ini_parser_error &err) {
+        throw Slic3r::RuntimeError(format("Failed loading config bundle \"%1%\"\nError: \"%2%\" at line %3%", path, err.message(), err.line()).c_str());
+    }
 
     const VendorProfile *vendor_profile = nullptr;
     if (flags.has(LoadConfigBundleAttribute::LoadSystem) || flags.has(LoadConfigBundleAttribute::LoadVendorOnly)) {
@@ -1466,6 +1617,7 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
     std::string              active_physical_printer;
     size_t                   presets_loaded = 0;
     size_t                   ph_printers_loaded = 0;
+    bool                     cache_complete = true;
 
     for (const auto &section : tree) {
         PresetCollection         *presets = nullptr;
@@ -1618,6 +1770,8 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
                 if (preset_existing != nullptr) {
                     BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle \"" << path << "\": The printer preset \"" << 
                         section.first << "\" has already been loaded from another Confing Bundle.";
+                    // The preset is missing in the cache, thus the cache would not be valid without the other config bundle.
+                    cache_complete = false;
                     continue;
                 }
             } else if (! flags.has(LoadConfigBundleAttribute::LoadSystem)) {
@@ -1637,16 +1791,10 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
 					BOOST_LOG_TRIVIAL(trace) << "A new " << presets->name() << " preset \"" << preset_name << "\" was imported from user Config Bundle \"" << path << "\"";
                 }
             }
+            if (use_cache)
+                cache.presets.push_back({ int(presets->type()), preset_name, std::string(), std::vector<std::string>(), config });
             // Decide a full path to this .ini file.
-            auto file_name = boost::algorithm::iends_with(preset_name, ".ini") ? preset_name : preset_name + ".ini";
-            auto file_path = (boost::filesystem::path(data_dir()) 
-#ifdef SLIC3R_PROFILE_USE_PRESETS_SUBDIR
-                // Store the print/filament/printer presets into a "presets" directory.
-                / "presets" 
-#else
-                // Store the print/filament/printer presets at the same location as the upstream Slic3r.
-#endif
-                / presets->section_name() / file_name).make_preferred();
+            auto file_path = config_bundle_preset_path(presets->section_name(), preset_name);
             // Load the preset into the list of presets, save it to disk.
             Preset &loaded = presets->load_preset(file_path.string(), preset_name, std::move(config), false);
             if (flags.has(LoadConfigBundleAttribute::SaveImported))
@@ -1672,6 +1820,10 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
 	        else 
 	         	loaded.alias = std::move(alias_name);
 	        loaded.renamed_from = std::move(renamed_from);
+            if (use_cache) {
+                cache.presets.back().alias        = loaded.alias;
+                cache.presets.back().renamed_from = loaded.renamed_from;
+            }
             if (! substitution_context.empty())
                 substitutions.push_back({ 
                     preset_name, presets->type(), PresetConfigSubstitutions::Source::ConfigBundle, 
@@ -1725,6 +1877,38 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
         }
     }
 
+    if (cache_loaded) {
+        // The presets were not parsed from the config bundle, load them from the cache.
+        for (ConfigBundleCache::CachedPreset &cached : cache.presets) {
+            PresetCollection &presets = this->get_presets(Preset::Type(cached.type));
+            if (&presets == &this->printers && presets.find_preset(cached.name, false) != nullptr) {
+                BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle \"" << path << "\": The printer preset \"printer:" << 
+                    cached.name << "\" has already been loaded from another Confing Bundle.";
+                continue;
+            }
+            Preset &loaded = presets.load_preset(config_bundle_preset_path(presets.section_name(), cached.name).string(), cached.name, std::move(cached.config), false);
+            if (flags.has(LoadConfigBundleAttribute::SaveImported))
+                loaded.save();
+            loaded.is_system    = true;
+            loaded.vendor       = vendor_profile;
+            loaded.alias        = std::move(cached.alias);
+            loaded.renamed_from = std::move(cached.renamed_from);
+            ++ presets_loaded;
+        }
+    } else if (use_cache && cache_complete && substitutions.empty() && ph_printers_loaded == 0) {
+        // Cache the presets together with the sections of the config bundle other than the presets.
+        pt::ptree sections;
+        for (const auto &section : tree)
+            if (! boost::starts_with(section.first, "print:") && ! boost::starts_with(section.first, "filament:") &&
+                ! boost::starts_with(section.first, "sla_print:") && ! boost::starts_with(section.first, "sla_material:") &&
+                ! boost::starts_with(section.first, "printer:") && ! boost::starts_with(section.first, "physical_printer:"))
+                sections.push_back(section);
+        std::ostringstream oss;
+        pt::write_ini(oss, sections);
+        cache.sections = oss.str();
+        save_config_bundle_cache(path, cache);
+    }
+
     // 3) Activate the presets and physical printer if any exists.
     if (! flags.has(LoadConfigBundleAttribute::LoadSystem)) {
         if (! active_print.empty()) 
@@ -146,6 +146,8 @@ public:
         // Load a system config bundle.
         LoadSystem,
         LoadVendorOnly,
+        // Load a system config bundle from a binary cache in the data directory if it is up to date, rebuild the cache otherwise.
+        UseCache,
     };
     using LoadConfigBundleAttributes = enum_bitmask<LoadConfigBundleAttribute>;
     // Load the config bundle based on the flags.
@@ -37,6 +37,7 @@
 #include "Utils.hpp"
 #include "BuildVolume.hpp"
 #include "format.hpp"
+#include "Arachne/WallToolPaths.hpp"
 
 #include <float.h>
 
@@ -67,6 +68,7 @@ void Print::clear()
 	m_objects.clear();
     m_print_regions.clear();
     m_model.clear_objects();
+    m_smooth_path_layer_cache.clear();
 }
 
 // Called by Print::apply().
@@ -973,13 +975,17 @@ void Print::process()
 
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
 
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1), [this](const tbb::blocked_range<size_t> &range) {
-        for (size_t idx = range.begin(); idx < range.end(); ++idx) {
-            m_objects[idx]->make_perimeters();
-            m_objects[idx]->infill();
-            m_objects[idx]->ironing();
-        }
-    }, tbb::simple_partitioner());
+    {
+        // Arachne toolpaths shared by the layers of all objects with identical slices, released once all the perimeters are generated.
+        Arachne::WallToolPathsCache wall_tool_paths_cache;
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1), [this, &wall_tool_paths_cache](const tbb::blocked_range<size_t> &range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++idx) {
+                m_objects[idx]->make_perimeters(wall_tool_paths_cache);
+                m_objects[idx]->infill();
+                m_objects[idx]->ironing();
+            }
+        }, tbb::simple_partitioner());
+    }
 
     // The following step writes to m_shared_regions, it should not run in parallel.
     for (PrintObject *obj : m_objects)
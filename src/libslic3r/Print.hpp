@@ -36,6 +36,7 @@
 #include "libslic3r/GCode/WipeTower.hpp"
 #include "libslic3r/GCode/ThumbnailData.hpp"
 #include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/GCode/SmoothPath.hpp"
 #include "MultiMaterialSegmentation.hpp"
 
 #include "libslic3r.h"
@@ -68,6 +69,10 @@ namespace FillLightning {
     using GeneratorPtr = std::unique_ptr<Generator, GeneratorDeleter>;
 }; // namespace FillLightning
 
+namespace Arachne {
+    class WallToolPathsCache;
+}; // namespace Arachne
+
 // Print step IDs for keeping track of the print state.
 // The Print steps are applied in this order.
 enum PrintStep : unsigned int {
@@ -388,7 +393,7 @@ private:
     static PrintObjectConfig object_config_from_model_object(const PrintObjectConfig &default_object_config, const ModelObject &object, size_t num_extruders);
 
 private:
-    void make_perimeters();
+    void make_perimeters(Arachne::WallToolPathsCache &wall_tool_paths_cache);
     void prepare_infill();
     void clear_fills();
     void infill();
@@ -721,6 +726,8 @@ private:
     // Following section will be consumed by the GCodeGenerator.
     ToolOrdering 							m_tool_ordering;
     WipeTowerData                           m_wipe_tower_data {m_tool_ordering};
+    // Smooth paths of the layers of the last G-code export, reused by the next export for the unchanged layers.
+    GCode::SmoothPathLayerCache             m_smooth_path_layer_cache;
 
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
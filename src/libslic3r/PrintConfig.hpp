@@ -48,7 +48,9 @@
 #include <algorithm>
 #include <initializer_list>
 #include <map>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -389,16 +391,26 @@ protected:
     {
     public:
         // To be called during the StaticCache setup.
-        // Add one ConfigOption into m_map_name_to_offset.
+        // Add one ConfigOption into m_name_to_offset.
+        // The name is a string literal produced by PRINT_CONFIG_CLASS_ELEMENT_INITIALIZATION, thus it is not copied.
         template<typename T>
-        void                opt_add(const std::string &name, const char *base_ptr, const T &opt)
+        void                opt_add(std::string_view name, const char *base_ptr, const T &opt)
         {
-            assert(m_map_name_to_offset.find(name) == m_map_name_to_offset.end());
-            m_map_name_to_offset[name] = (const char*)&opt - base_ptr;
+            m_name_to_offset.emplace_back(name, (const char*)&opt - base_ptr);
         }
 
     protected:
-        std::map<std::string, ptrdiff_t>    m_map_name_to_offset;
+        // Sorted by name in StaticCache::finalize().
+        // A sorted vector of string views is much cheaper to build at application start than a std::map of strings,
+        // and it is faster to search.
+        std::vector<std::pair<std::string_view, ptrdiff_t>> m_name_to_offset;
+
+        std::optional<ptrdiff_t> offset(std::string_view name) const
+        {
+            auto it = std::lower_bound(m_name_to_offset.begin(), m_name_to_offset.end(), name,
+                [](const std::pair<std::string_view, ptrdiff_t> &l, std::string_view r) { return l.first < r; });
+            return it == m_name_to_offset.end() || it->first != name ? std::nullopt : std::make_optional(it->second);
+        }
     };
 
     // Parametrized by the type of the topmost class owning the options.
@@ -414,39 +426,45 @@ protected:
 
         ConfigOption*       optptr(const std::string &name, T *owner) const
         {
-            const auto it = m_map_name_to_offset.find(name);
-            return (it == m_map_name_to_offset.end()) ? nullptr : reinterpret_cast<ConfigOption*>((char*)owner + it->second);
+            const std::optional<ptrdiff_t> offset = this->offset(name);
+            return offset ? reinterpret_cast<ConfigOption*>((char*)owner + *offset) : nullptr;
         }
 
         const ConfigOption* optptr(const std::string &name, const T *owner) const
         {
-            const auto it = m_map_name_to_offset.find(name);
-            return (it == m_map_name_to_offset.end()) ? nullptr : reinterpret_cast<const ConfigOption*>((const char*)owner + it->second);
+            const std::optional<ptrdiff_t> offset = this->offset(name);
+            return offset ? reinterpret_cast<const ConfigOption*>((const char*)owner + *offset) : nullptr;
         }
 
         const std::vector<std::string>& keys()      const { return m_keys; }
         const T&                        defaults()  const { return *m_defaults; }
 
         // To be called during the StaticCache setup.
-        // Collect option keys from m_map_name_to_offset,
+        // Collect option keys from m_name_to_offset,
         // assign default values to m_defaults.
         void                finalize(T *defaults, const ConfigDef *defs)
         {
             assert(defs != nullptr);
             m_defaults = defaults;
+            std::sort(m_name_to_offset.begin(), m_name_to_offset.end());
+            assert(std::adjacent_find(m_name_to_offset.begin(), m_name_to_offset.end(),
+                [](const auto &l, const auto &r) { return l.first == r.first; }) == m_name_to_offset.end());
             m_keys.clear();
-            m_keys.reserve(m_map_name_to_offset.size());
-            for (const auto &kvp : defs->options) {
-                // Find the option given the option name kvp.first by an offset from (char*)m_defaults.
-                ConfigOption *opt = this->optptr(kvp.first, m_defaults);
-                if (opt == nullptr)
-                    // This option is not defined by the ConfigBase of type T.
+            m_keys.reserve(m_name_to_offset.size());
+            // Both m_name_to_offset and defs->options are sorted by the option name, thus the options of T
+            // are matched with their definitions by a single merge pass.
+            auto it_def = defs->options.begin();
+            for (const auto &[name, offset] : m_name_to_offset) {
+                while (it_def != defs->options.end() && std::string_view(it_def->first) < name)
+                    ++ it_def;
+                if (it_def == defs->options.end())
+                    break;
+                if (it_def->first != name)
+                    // This option is not defined by the ConfigDef.
                     continue;
-                m_keys.emplace_back(kvp.first);
-                const ConfigOptionDef *def = defs->get(kvp.first);
-                assert(def != nullptr);
-                if (def->default_value)
-                    opt->set(def->default_value.get());
+                m_keys.emplace_back(name);
+                if (const ConfigOptionDef &def = it_def->second; def.default_value)
+                    reinterpret_cast<ConfigOption*>((char*)m_defaults + offset)->set(def.default_value.get());
             }
         }
 
@@ -1547,9 +1565,10 @@ namespace cereal {
         for (size_t i = 0; i < cnt; ++ i) {
             size_t serialization_key_ordinal;
             archive(serialization_key_ordinal);
-            assert(serialization_key_ordinal > 0);
             auto it = Slic3r::print_config_def.by_serialization_key_ordinal.find(serialization_key_ordinal);
-            assert(it != Slic3r::print_config_def.by_serialization_key_ordinal.end());
+            // The archive may be read from a file (config bundle cache), thus validate the ordinal in release mode too.
+            if (it == Slic3r::print_config_def.by_serialization_key_ordinal.end())
+                throw cereal::Exception("Invalid serialization key ordinal of a DynamicPrintConfig option");
             config.set_key_value(it->second->opt_key, it->second->load_option_from_archive(archive));
         }
     }
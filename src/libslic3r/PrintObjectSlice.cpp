@@ -5,8 +5,10 @@
 #include <boost/log/trivial.hpp>
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -69,6 +71,33 @@ LayerPtrs new_layers(
     return out;
 }
 
+// Slice huge meshes (3D scans) in batches of layers to bound the memory of the intersection lines to a few hundred MB.
+static constexpr size_t slice_volume_sweep_max_lines = 8 * 1024 * 1024;
+
+// Upper estimate of the number of intersection lines produced by slicing a mesh transformed by trafo at zs:
+// Sum of the numbers of layers crossing the Z span of each face.
+static size_t slice_volume_num_lines_estimate(const indexed_triangle_set &its, const Transform3d &trafo, const std::vector<float> &zs)
+{
+    const Vec3d  axis_z  = trafo.linear().row(2).transpose();
+    const double shift_z = trafo.translation().z();
+    return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, its.indices.size(), 4096), size_t(0),
+        [&its, &zs, &axis_z, shift_z](const tbb::blocked_range<size_t> &range, size_t num_lines) {
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                const stl_triangle_vertex_indices &face = its.indices[face_idx];
+                float zmin = std::numeric_limits<float>::max();
+                float zmax = std::numeric_limits<float>::lowest();
+                for (int i = 0; i < 3; ++ i) {
+                    const float z = float(axis_z.dot(its.vertices[face(i)].cast<double>()) + shift_z);
+                    zmin = std::min(zmin, z);
+                    zmax = std::max(zmax, z);
+                }
+                num_lines += std::upper_bound(zs.begin(), zs.end(), zmax) - std::lower_bound(zs.begin(), zs.end(), zmin);
+            }
+            return num_lines;
+        },
+        std::plus<size_t>());
+}
+
 // Slice single triangle mesh.
 static std::vector<ExPolygons> slice_volume(
     const ModelVolume             &volume,
@@ -78,13 +107,25 @@ static std::vector<ExPolygons> slice_volume(
 {
     std::vector<ExPolygons> layers;
     if (! zs.empty()) {
-        indexed_triangle_set its = volume.mesh().its;
-        if (its.indices.size() > 0) {
+        const TriangleMesh &mesh = volume.mesh();
+        if (mesh.its.indices.size() > 0) {
             MeshSlicingParamsEx params2 { params };
             params2.trafo = params2.trafo * volume.get_matrix();
-            if (params2.trafo.rotation().determinant() < 0.)
+            // Only enable the sweep plane slicing if all the intersection lines would not fit into the memory budget,
+            // the sweep needs an extra pass over the faces and sorts them.
+            if (mesh.its.indices.size() * zs.size() > slice_volume_sweep_max_lines &&
+                slice_volume_num_lines_estimate(mesh.its, params2.trafo, zs) > slice_volume_sweep_max_lines)
+                params2.sweep_max_lines = slice_volume_sweep_max_lines;
+            // Face edge IDs are cached at the mesh shared by ModelVolume, thus they are reused when re-slicing the volume.
+            std::shared_ptr<const std::vector<Vec3i>> face_edge_ids = mesh.face_edge_ids();
+            if (params2.trafo.rotation().determinant() < 0.) {
+                indexed_triangle_set its = mesh.its;
                 its_flip_triangles(its);
-            layers = slice_mesh_ex(its, zs, params2, throw_on_cancel_callback);
+                std::vector<Vec3i> flipped_face_edge_ids = *face_edge_ids;
+                its_flip_face_edges(flipped_face_edge_ids);
+                layers = slice_mesh_ex(its, flipped_face_edge_ids, zs, params2, throw_on_cancel_callback);
+            } else
+                layers = slice_mesh_ex(mesh.its, *face_edge_ids, zs, params2, throw_on_cancel_callback);
             throw_on_cancel_callback();
         }
     }
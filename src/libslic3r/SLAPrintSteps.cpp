@@ -429,18 +429,31 @@ static std::vector<ExPolygons> slice_volumes(
     Pred &&predicate)
 {
     indexed_triangle_set mesh;
+    // Face edge IDs of the merged mesh, composed of the face edge IDs cached at the volume meshes.
+    std::vector<Vec3i>   face_edge_ids;
+    int                  num_edges = 0;
     for (const ModelVolume *vol : volumes) {
         if (predicate(vol)) {
             indexed_triangle_set vol_mesh = vol->mesh().its;
             its_transform(vol_mesh, trafo * vol->get_matrix());
             its_merge(mesh, vol_mesh);
+            int max_edge_id = -1;
+            for (const Vec3i &edge_ids : *vol->mesh().face_edge_ids()) {
+                Vec3i &dst = face_edge_ids.emplace_back(edge_ids);
+                for (int i = 0; i < 3; ++ i)
+                    if (dst(i) != -1) {
+                        max_edge_id = std::max(max_edge_id, dst(i));
+                        dst(i) += num_edges;
+                    }
+            }
+            num_edges += max_edge_id + 1;
         }
     }
 
     std::vector<ExPolygons> out;
 
     if (!mesh.empty()) {
-        out = slice_mesh_ex(mesh, slice_grid, slice_params);
+        out = slice_mesh_ex(mesh, face_edge_ids, slice_grid, slice_params);
     }
 
     return out;
@@ -16,6 +16,8 @@
 #include <libqhullcpp/Qhull.h>
 #include <libqhullcpp/QhullFacetList.h>
 #include <libqhullcpp/QhullVertexSet.h>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/predef/other/endian.h>
@@ -26,6 +28,10 @@
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/concurrent_vector.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/parallel_reduce.h>
+#include <oneapi/tbb/parallel_sort.h>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <vector>
 #include <utility>
@@ -93,6 +99,222 @@ TriangleMesh::TriangleMesh(indexed_triangle_set &&its, const RepairedMeshErrors&
     fill_initial_stats(this->its, m_stats);
 }
 
+bool stl_open_mapped(stl_file *stl, const char *file)
+{
+#if BOOST_ENDIAN_BIG_BYTE
+    // The facets are stored little endian, let admesh convert them.
+    return stl_open(stl, file);
+#else /* BOOST_ENDIAN_BIG_BYTE */
+    boost::iostreams::mapped_file_source mapped;
+    try {
+        const boost::filesystem::path path(file);
+        if (boost::filesystem::file_size(path) < STL_MIN_FILE_SIZE)
+            // Not a valid binary STL, let admesh report the error or parse a short ASCII STL.
+            return stl_open(stl, file);
+        mapped.open(path);
+    } catch (const std::exception &) {
+        return stl_open(stl, file);
+    }
+    if (! mapped.is_open())
+        return stl_open(stl, file);
+
+    // Test for a binary STL the same way stl_open_count_facets() does.
+    const char  *data      = mapped.data();
+    const size_t file_size = mapped.size();
+    if (std::none_of(data + HEADER_SIZE, data + HEADER_SIZE + 128, [](char c) { return static_cast<unsigned char>(c) > 127; }) ||
+        (file_size - HEADER_SIZE) % SIZEOF_STL_FACET != 0) {
+        mapped.close();
+        return stl_open(stl, file);
+    }
+
+    stl->clear();
+    stl->stats.type = binary;
+    memcpy(stl->stats.header, data, LABEL_SIZE);
+    const uint32_t num_facets = uint32_t((file_size - HEADER_SIZE) / SIZEOF_STL_FACET);
+    uint32_t       header_num_facets;
+    memcpy(&header_num_facets, data + LABEL_SIZE, sizeof(uint32_t));
+    if (num_facets != header_num_facets)
+        BOOST_LOG_TRIVIAL(info) << "stl_open_mapped: Warning: File size doesn't match number of facets in the header: " << file;
+    stl->stats.number_of_facets    = num_facets;
+    stl->stats.original_num_facets = int(num_facets);
+    stl_allocate(stl);
+
+    // Unpack the facets and collect their bounding box. Each block starts with the first vertex as stl_facet_stats() does
+    // and the blocks are merged left to right, thus the bounding box is the same as if the facets were read serially.
+    const char *facets = data + HEADER_SIZE;
+    memcpy(static_cast<void*>(&stl->facet_start.front()), facets, SIZEOF_STL_FACET);
+    const stl_facet &first = stl->facet_start.front();
+    using BBox = std::pair<stl_vertex, stl_vertex>;
+    BBox bbox = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, num_facets, 4096), BBox(first.vertex[0], first.vertex[0]),
+        [stl, facets](const tbb::blocked_range<size_t> &range, BBox bbox) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                stl_facet &facet = stl->facet_start[i];
+                memcpy(static_cast<void*>(&facet), facets + i * SIZEOF_STL_FACET, SIZEOF_STL_FACET);
+                for (const stl_vertex &v : facet.vertex) {
+                    bbox.first  = bbox.first.cwiseMin(v);
+                    bbox.second = bbox.second.cwiseMax(v);
+                }
+            }
+            return bbox;
+        },
+        [](const BBox &l, const BBox &r) { return BBox(l.first.cwiseMin(r.first), l.second.cwiseMax(r.second)); });
+
+    stl->stats.min = bbox.first;
+    stl->stats.max = bbox.second;
+    stl_vertex diff = (first.vertex[1] - first.vertex[0]).cwiseAbs();
+    stl->stats.shortest_edge     = std::max(diff(0), std::max(diff(1), diff(2)));
+    stl->stats.size              = stl->stats.max - stl->stats.min;
+    stl->stats.bounding_diameter = stl->stats.size.norm();
+    return true;
+#endif /* BOOST_ENDIAN_BIG_BYTE */
+}
+
+void stl_check_facets_exact_parallel(stl_file *stl)
+{
+    assert(stl->facet_start.size() == stl->neighbors_start.size());
+
+    stl->stats.connected_edges         = 0;
+    stl->stats.connected_facets_1_edge = 0;
+    stl->stats.connected_facets_2_edge = 0;
+    stl->stats.connected_facets_3_edge = 0;
+
+    // Remove the degenerate facets the same way stl_check_facets_exact() does, the order of the remaining facets matters.
+    for (uint32_t i = 0; i < stl->stats.number_of_facets;) {
+        stl_facet &facet = stl->facet_start[i];
+        if (facet.vertex[0] == facet.vertex[1] || facet.vertex[1] == facet.vertex[2] || facet.vertex[0] == facet.vertex[2]) {
+            facet = stl->facet_start[-- stl->stats.number_of_facets];
+            stl->facet_start.pop_back();
+            stl->neighbors_start.pop_back();
+            stl->stats.facets_removed += 1;
+            stl->stats.degenerate_facets += 1;
+        } else
+            ++ i;
+    }
+
+    const size_t num_facets = stl->stats.number_of_facets;
+    for (stl_neighbors &neighbor : stl->neighbors_start)
+        neighbor.reset();
+    // Accumulated serially to reproduce std::min() of stl_check_facets_exact() even for not a numbers.
+    for (const stl_facet &facet : stl->facet_start)
+        for (int j = 0; j < 3; ++ j) {
+            stl_vertex diff = (facet.vertex[j] - facet.vertex[(j + 1) % 3]).cwiseAbs();
+            stl->stats.shortest_edge = std::min(std::max(diff(0), std::max(diff(1), diff(2))), stl->stats.shortest_edge);
+        }
+
+    // Number the unique vertices. Negative zeros are switched to positive zeros, thus two vertices share a key
+    // if and only if the edges of admesh hash table compare their coordinates equal.
+    struct VertexKey {
+        std::array<uint32_t, 3> key;
+        uint32_t                idx;
+    };
+    std::vector<VertexKey> vertex_keys(num_facets * 3);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets), [stl, &vertex_keys](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            for (size_t j = 0; j < 3; ++ j) {
+                VertexKey &vk = vertex_keys[i * 3 + j];
+                memcpy(vk.key.data(), stl->facet_start[i].vertex[j].data(), sizeof(stl_vertex));
+                for (uint32_t &k : vk.key)
+                    if (k == 0x80000000u)
+                        k = 0;
+                vk.idx = uint32_t(i * 3 + j);
+            }
+    });
+    tbb::parallel_sort(vertex_keys.begin(), vertex_keys.end(), [](const VertexKey &l, const VertexKey &r) { return l.key < r.key; });
+    // Vertex ID is the position of the first occurence of its key in the sorted sequence.
+    std::vector<uint32_t> vertex_ids(num_facets * 3);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, vertex_keys.size()), [&vertex_keys, &vertex_ids](const tbb::blocked_range<size_t> &range) {
+        size_t head = range.begin();
+        for (; head > 0 && vertex_keys[head - 1].key == vertex_keys[range.begin()].key; -- head) ;
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            if (vertex_keys[i].key != vertex_keys[head].key)
+                head = i;
+            vertex_ids[vertex_keys[i].idx] = uint32_t(head);
+        }
+    });
+    vertex_keys = {};
+
+    // Edges oriented by HashEdge::load_exact(), sorted by their vertices and then by the order of insertion into the admesh hash table.
+    struct EdgeKey {
+        uint64_t key;
+        // facet_idx * 3 + index of the edge in the facet.
+        uint32_t edge_id;
+        // Index of the edge in the facet, increased by 3 if the edge is stored backwards.
+        uint32_t which_edge;
+        int      facet() const { return int(edge_id / 3); }
+    };
+    std::vector<EdgeKey> edges(num_facets * 3);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_facets), [stl, &vertex_ids, &edges](const tbb::blocked_range<size_t> &range) {
+        auto vertex_lower = [](const stl_vertex &a, const stl_vertex &b) {
+            return (a(0) != b(0)) ? (a(0) < b(0)) : ((a(1) != b(1)) ? (a(1) < b(1)) : (a(2) < b(2)));
+        };
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const stl_facet &facet = stl->facet_start[i];
+            for (size_t j = 0; j < 3; ++ j) {
+                size_t   j2 = (j + 1) % 3;
+                uint32_t a  = vertex_ids[i * 3 + j];
+                uint32_t b  = vertex_ids[i * 3 + j2];
+                EdgeKey &edge = edges[i * 3 + j];
+                edge.edge_id    = uint32_t(i * 3 + j);
+                edge.which_edge = uint32_t(j);
+                if (! vertex_lower(facet.vertex[j], facet.vertex[j2])) {
+                    std::swap(a, b);
+                    edge.which_edge += 3;
+                }
+                edge.key = (uint64_t(a) << 32) | b;
+            }
+        }
+    });
+    vertex_ids = {};
+    tbb::parallel_sort(edges.begin(), edges.end(), [](const EdgeKey &l, const EdgeKey &r) { return l.key < r.key || (l.key == r.key && l.edge_id < r.edge_id); });
+
+    // Connect the edges sharing a key in the order the admesh hash table would: An edge is connected to the first not yet
+    // connected edge of another facet, otherwise it waits for a match. A block owns the runs of equal keys starting inside it.
+    // Each facet edge is written to at most once, thus the blocks do not need to synchronize.
+    std::atomic<size_t> num_matches(0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, edges.size()), [stl, &edges, &num_matches](const tbb::blocked_range<size_t> &range) {
+        size_t                      begin = range.begin();
+        for (; begin > 0 && begin < range.end() && edges[begin - 1].key == edges[begin].key; ++ begin) ;
+        size_t                      matches = 0;
+        std::vector<const EdgeKey*> waiting;
+        for (size_t run_begin = begin; run_begin < range.end();) {
+            size_t run_end = run_begin + 1;
+            for (; run_end < edges.size() && edges[run_end].key == edges[run_begin].key; ++ run_end) ;
+            waiting.clear();
+            for (size_t i = run_begin; i < run_end; ++ i) {
+                const EdgeKey &edge_a = edges[i];
+                auto it = std::find_if(waiting.begin(), waiting.end(), [&edge_a](const EdgeKey *e) { return e->facet() != edge_a.facet(); });
+                if (it == waiting.end()) {
+                    waiting.emplace_back(&edge_a);
+                    continue;
+                }
+                const EdgeKey &edge_b = **it;
+                waiting.erase(it);
+                // Same as HashTableEdges::record_neighbors(), the statistics are collected at the end.
+                // If both edges are oriented the same way, their facets are oriented in opposite directions.
+                int flipped = (edge_a.which_edge < 3) == (edge_b.which_edge < 3) ? 3 : 0;
+                stl_neighbors &neighbors_a = stl->neighbors_start[edge_a.facet()];
+                stl_neighbors &neighbors_b = stl->neighbors_start[edge_b.facet()];
+                neighbors_a.neighbor[edge_a.which_edge % 3]         = edge_b.facet();
+                neighbors_a.which_vertex_not[edge_a.which_edge % 3] = char((edge_b.which_edge + 2) % 3 + flipped);
+                neighbors_b.neighbor[edge_b.which_edge % 3]         = edge_a.facet();
+                neighbors_b.which_vertex_not[edge_b.which_edge % 3] = char((edge_a.which_edge + 2) % 3 + flipped);
+                ++ matches;
+            }
+            run_begin = run_end;
+        }
+        num_matches += matches;
+    });
+
+    stl->stats.connected_edges = int(num_matches * 2);
+    for (const stl_neighbors &neighbors : stl->neighbors_start)
+        switch (neighbors.num_neighbors()) {
+        case 3: ++ stl->stats.connected_facets_3_edge; [[fallthrough]];
+        case 2: ++ stl->stats.connected_facets_2_edge; [[fallthrough]];
+        case 1: ++ stl->stats.connected_facets_1_edge; break;
+        default: break;
+        }
+}
+
 // #define SLIC3R_TRACE_REPAIR
 
 static void trianglemesh_repair_on_import(stl_file &stl)
@@ -108,7 +330,7 @@ static void trianglemesh_repair_on_import(stl_file &stl)
     BOOST_LOG_TRIVIAL(trace) << "\tstl_check_faces_exact";
 #endif /* SLIC3R_TRACE_REPAIR */
     assert(stl_validate(&stl));
-    stl_check_facets_exact(&stl);
+    stl_check_facets_exact_parallel(&stl);
     assert(stl_validate(&stl));
     stl.stats.facets_w_1_bad_edge = (stl.stats.connected_facets_2_edge - stl.stats.connected_facets_3_edge);
     stl.stats.facets_w_2_bad_edge = (stl.stats.connected_facets_1_edge - stl.stats.connected_facets_2_edge);
@@ -192,7 +414,7 @@ static void trianglemesh_repair_on_import(stl_file &stl)
 
     //FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
     if (auto nr_degenerated = stl.stats.degenerate_facets; stl.stats.number_of_facets > 0 && nr_degenerated > 0)
-        stl_check_facets_exact(&stl);
+        stl_check_facets_exact_parallel(&stl);
 
     BOOST_LOG_TRIVIAL(debug) << "TriangleMesh::repair() finished";
 }
@@ -213,12 +435,13 @@ void TriangleMesh::from_facets(std::vector<stl_facet> &&facets, bool repair)
 
     stl_generate_shared_vertices(&stl, this->its);
     fill_initial_stats(this->its, this->m_stats);
+    m_topology.clear();
 }
 
 bool TriangleMesh::ReadSTLFile(const char* input_file, bool repair)
 { 
     stl_file stl;
-    if (! stl_open(&stl, input_file))
+    if (! stl_open_mapped(&stl, input_file))
         return false;
     if (repair)
         trianglemesh_repair_on_import(stl);
@@ -243,6 +466,7 @@ bool TriangleMesh::ReadSTLFile(const char* input_file, bool repair)
     m_stats.number_of_parts         = stl.stats.number_of_parts;
 
     stl_generate_shared_vertices(&stl, this->its);
+    m_topology.clear();
     return true;
 }
 
@@ -357,6 +581,7 @@ void TriangleMesh::mirror(const Axis axis)
         return;
     };
     its_flip_triangles(this->its);
+    m_topology.clear();
     int iaxis = int(axis);
     std::swap(m_stats.min[iaxis], m_stats.max[iaxis]);
     m_stats.min[iaxis] *= -1.0;
@@ -369,6 +594,7 @@ void TriangleMesh::transform(const Transform3d& t, bool fix_left_handed)
     double det = t.matrix().block(0, 0, 3, 3).determinant();
     if (fix_left_handed && det < 0.) {
         its_flip_triangles(its);
+        m_topology.clear();
         det = -det;
     }
     m_stats.volume *= det;
@@ -381,6 +607,7 @@ void TriangleMesh::transform(const Matrix3d& m, bool fix_left_handed)
     double det = m.block(0, 0, 3, 3).determinant();
     if (fix_left_handed && det < 0.) {
         its_flip_triangles(its);
+        m_topology.clear();
         det = -det;
     }
     m_stats.volume *= det;
@@ -390,6 +617,7 @@ void TriangleMesh::transform(const Matrix3d& m, bool fix_left_handed)
 void TriangleMesh::flip_triangles()
 {
     its_flip_triangles(its);
+    m_topology.clear();
     m_stats.volume = - m_stats.volume;
 }
 
@@ -444,6 +672,7 @@ void TriangleMesh::merge(const TriangleMesh &mesh)
 {
     its_merge(this->its, mesh.its);
     m_stats = m_stats.merge(mesh.m_stats);
+    m_topology.clear();
 }
 
 // Calculate projection of the mesh into the XY plane, in scaled coordinates.
@@ -548,6 +777,57 @@ std::vector<ExPolygons> TriangleMesh::slice(const std::vector<double> &z) const
     return slice_mesh_ex(this->its, z_f, 0.0004f);
 }
 
+template<typename T, typename Calculate>
+std::shared_ptr<const T> TriangleMeshTopology::get(std::shared_ptr<const T> &cached, const indexed_triangle_set &its, Calculate calculate) const
+{
+    // Holding the lock while calculating, so that concurrent slicing of the same mesh calculates the topology once.
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    if (m_indices != its.indices.data() || m_num_faces != its.indices.size()) {
+        // The indices were replaced since the topology was cached.
+        m_face_neighbors.reset();
+        m_face_edge_ids.reset();
+        m_vertex_faces.reset();
+        m_indices   = its.indices.data();
+        m_num_faces = its.indices.size();
+    }
+    if (! cached)
+        cached = std::make_shared<const T>(calculate());
+    return cached;
+}
+
+std::shared_ptr<const std::vector<Vec3i>> TriangleMeshTopology::face_neighbors(const indexed_triangle_set &its) const
+{
+    return this->get(m_face_neighbors, its, [&its]() { return its_face_neighbors_par(its); });
+}
+
+std::shared_ptr<const std::vector<Vec3i>> TriangleMeshTopology::face_edge_ids(const indexed_triangle_set &its) const
+{
+    return this->get(m_face_edge_ids, its, [&its]() { return its_face_edge_ids(its); });
+}
+
+std::shared_ptr<const VertexFaceIndex> TriangleMeshTopology::vertex_faces(const indexed_triangle_set &its) const
+{
+    return this->get(m_vertex_faces, its, [&its]() { return VertexFaceIndex(its); });
+}
+
+size_t TriangleMeshTopology::clear()
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    size_t released = 0;
+    if (m_face_neighbors)
+        released += m_face_neighbors->capacity() * sizeof(Vec3i);
+    if (m_face_edge_ids)
+        released += m_face_edge_ids->capacity() * sizeof(Vec3i);
+    if (m_vertex_faces)
+        released += m_vertex_faces->memsize();
+    m_face_neighbors.reset();
+    m_face_edge_ids.reset();
+    m_vertex_faces.reset();
+    m_indices   = nullptr;
+    m_num_faces = 0;
+    return released;
+}
+
 size_t TriangleMesh::memsize() const
 {
     size_t memsize = 8 + this->its.memsize() + sizeof(m_stats);
@@ -776,6 +1056,14 @@ void its_flip_triangles(indexed_triangle_set &its)
         std::swap(face(1), face(2));
 }
 
+void its_flip_face_edges(std::vector<Vec3i> &face_edges)
+{
+    // Flipping face (v0, v1, v2) to (v0, v2, v1) turns its edges (v0, v1), (v1, v2), (v2, v0)
+    // into (v2, v1), (v1, v0), (v0, v2), thus the first and the last edge swap places.
+    for (Vec3i &edges : face_edges)
+        std::swap(edges(0), edges(2));
+}
+
 int its_num_degenerate_faces(const indexed_triangle_set &its)
 {
     return std::count_if(its.indices.begin(), its.indices.end(), [](auto &face) {
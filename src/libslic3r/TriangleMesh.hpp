@@ -18,6 +18,8 @@
 #include <stdint.h>
 #include <cereal/cereal.hpp>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <Eigen/Geometry>
 #include <array>
@@ -38,6 +40,7 @@ namespace Slic3r {
 
 class TriangleMesh;
 class TriangleMeshSlicer;
+struct VertexFaceIndex;
 
 struct RepairedMeshErrors {
     // How many edges were united by merging their end points with some other end points in epsilon neighborhood?
@@ -107,6 +110,42 @@ struct TriangleMeshStats {
     bool repaired() const { return repaired_errors.repaired(); }
 };
 
+// Topology of a triangle mesh, calculated on demand and cached for repeated slicing of the same mesh.
+// The topology depends on the vertex indices only, thus it survives transformations of the vertices.
+// The cached items are immutable and shared with the callers, thus they survive clear() while being used.
+// The owner of the cache shall clear() it whenever the indices are modified. In addition, the cache is keyed by the address
+// and the number of the indices, thus the topology is recalculated if the indices were reallocated or resized.
+class TriangleMeshTopology
+{
+public:
+    TriangleMeshTopology() = default;
+    // Copies start with an empty cache, the indices of a copy are stored at a different address.
+    TriangleMeshTopology(const TriangleMeshTopology &) {}
+    TriangleMeshTopology& operator=(const TriangleMeshTopology &) { this->clear(); return *this; }
+
+    // See its_face_neighbors().
+    std::shared_ptr<const std::vector<Vec3i>>   face_neighbors(const indexed_triangle_set &its) const;
+    // See its_face_edge_ids().
+    std::shared_ptr<const std::vector<Vec3i>>   face_edge_ids(const indexed_triangle_set &its) const;
+    // See VertexFaceIndex.
+    std::shared_ptr<const VertexFaceIndex>      vertex_faces(const indexed_triangle_set &its) const;
+
+    // Release the cached topology. Returns the amount of memory released.
+    size_t clear();
+
+private:
+    template<typename T, typename Calculate>
+    std::shared_ptr<const T> get(std::shared_ptr<const T> &cached, const indexed_triangle_set &its, Calculate calculate) const;
+
+    mutable std::mutex                                  m_mutex;
+    // Indices the cached topology was calculated for.
+    mutable const stl_triangle_vertex_indices          *m_indices { nullptr };
+    mutable size_t                                      m_num_faces { 0 };
+    mutable std::shared_ptr<const std::vector<Vec3i>>   m_face_neighbors;
+    mutable std::shared_ptr<const std::vector<Vec3i>>   m_face_edge_ids;
+    mutable std::shared_ptr<const VertexFaceIndex>      m_vertex_faces;
+};
+
 class TriangleMesh
 {
 public:
@@ -115,7 +154,7 @@ public:
     TriangleMesh(std::vector<Vec3f> &&vertices, const std::vector<Vec3i> &&faces);
     explicit TriangleMesh(const indexed_triangle_set &M);
     explicit TriangleMesh(indexed_triangle_set &&M, const RepairedMeshErrors& repaired_errors = RepairedMeshErrors());
-    void clear() { this->its.clear(); m_stats.clear(); }
+    void clear() { this->its.clear(); m_stats.clear(); m_topology.clear(); }
     void from_facets(std::vector<stl_facet> &&facets, bool repair = true);
     bool ReadSTLFile(const char* input_file, bool repair = true);
     bool write_ascii(const char* output_file);
@@ -167,11 +206,18 @@ public:
     // Estimate of the memory occupied by this structure, important for keeping an eye on the Undo / Redo stack allocation.
     size_t memsize() const;
 
-    // Used by the Undo / Redo stack, legacy interface. As of now there is nothing cached at TriangleMesh,
-    // but we may decide to cache some data in the future (for example normals), thus we keep the interface in place.
+    // Topology of this mesh, calculated on first use and cached, see TriangleMeshTopology.
+    // The methods of TriangleMesh modifying its.indices release the cached topology right away, code modifying its.indices
+    // directly shall call invalidate_topology().
+    std::shared_ptr<const std::vector<Vec3i>> face_neighbors() const { return m_topology.face_neighbors(this->its); }
+    std::shared_ptr<const std::vector<Vec3i>> face_edge_ids()  const { return m_topology.face_edge_ids(this->its); }
+    std::shared_ptr<const VertexFaceIndex>    vertex_faces()   const { return m_topology.vertex_faces(this->its); }
+    void                                      invalidate_topology()  { m_topology.clear(); }
+
+    // Used by the Undo / Redo stack, legacy interface. The only data cached at TriangleMesh is the topology.
     // Release optional data from the mesh if the object is on the Undo / Redo stack only. Returns the amount of memory released.
-    size_t release_optional() { return 0; }
-    // Restore optional data possibly released by release_optional().
+    size_t release_optional() { return m_topology.clear(); }
+    // Restore optional data possibly released by release_optional(). The topology is recalculated on demand.
     void   restore_optional() {}
 
     const TriangleMeshStats& stats() const { return m_stats; }
@@ -179,7 +225,8 @@ public:
     indexed_triangle_set its;
 
 private:
-    TriangleMeshStats m_stats;
+    TriangleMeshStats    m_stats;
+    TriangleMeshTopology m_topology;
 };
 
 // Index of face indices incident with a vertex index.
@@ -202,6 +249,8 @@ public:
 
     const Range<iterator> operator[](size_t vertex_id) const { return {begin(vertex_id), end(vertex_id)}; }
 
+    size_t   memsize() const { return (m_vertex_to_face_start.capacity() + m_vertex_faces_all.capacity()) * sizeof(size_t); }
+
 private:
     std::vector<size_t>     m_vertex_to_face_start;
     std::vector<size_t>     m_vertex_faces_all;
@@ -222,6 +271,8 @@ std::vector<Vec3i> its_face_neighbors_par(const indexed_triangle_set &its);
 
 // After applying a transformation with negative determinant, flip the faces to keep the transformed mesh volume positive.
 void its_flip_triangles(indexed_triangle_set &its);
+// Update face edge IDs (see its_face_edge_ids()) or face neighbors (see its_face_neighbors()) after its_flip_triangles().
+void its_flip_face_edges(std::vector<Vec3i> &face_edges);
 
 // Merge duplicate vertices, return number of vertices removed.
 // This function will happily create non-manifolds if more than two faces share the same vertex position
@@ -362,6 +413,13 @@ inline bool its_write_stl_ascii(const char *file, const char *label, const index
 bool        its_write_stl_binary(const char *file, const char *label, const std::vector<stl_triangle_vertex_indices> &indices, const std::vector<stl_vertex> &vertices);
 inline bool its_write_stl_binary(const char *file, const char *label, const indexed_triangle_set &its) { return its_write_stl_binary(file, label, its.indices, its.vertices); }
 
+// Drop-in replacement of admesh stl_open(): A binary STL is memory mapped and its facets are unpacked in parallel,
+// an ASCII STL is read by stl_open().
+bool        stl_open_mapped(stl_file *stl, const char *file);
+// Drop-in replacement of admesh stl_check_facets_exact() producing the very same neighbors and statistics.
+// Instead of inserting the edges into a hash table one by one, the vertices and edges are sorted in parallel.
+void        stl_check_facets_exact_parallel(stl_file *stl);
+
 inline BoundingBoxf3 bounding_box(const TriangleMesh &m) { return m.bounding_box(); }
 inline BoundingBoxf3 bounding_box(const indexed_triangle_set& its)
 {
@@ -404,6 +462,7 @@ namespace cereal {
     template<class Archive> void load(Archive &archive, Slic3r::TriangleMesh &mesh) {
         archive.loadBinary(reinterpret_cast<char*>(const_cast<Slic3r::TriangleMeshStats*>(&mesh.stats())), sizeof(Slic3r::TriangleMeshStats));
         archive(mesh.its.indices, mesh.its.vertices);
+        mesh.invalidate_topology();
     }
     template<class Archive> void save(Archive &archive, const Slic3r::TriangleMesh &mesh) {
         archive.saveBinary(reinterpret_cast<const char*>(&mesh.stats()), sizeof(Slic3r::TriangleMeshStats));
@@ -182,6 +182,21 @@ inline Point v3f_scaled_to_contour_point(const Eigen::MatrixBase<Derived> &v)
     return { coord_t(std::floor(v.x() + T(0.5))), coord_t(std::floor(v.y() + T(0.5))) };
 }
 
+// Intersection of a triangle edge crossing the slicing plane in a general position, a_id < b_id to give a consistent answer.
+// Shared by slice_facet() and slice_facet_run() to produce bit identical results.
+template<typename T>
+inline Point slice_edge(
+    const T                                         slice_z,
+    const Eigen::Matrix<T, 3, 1, Eigen::DontAlign> &a,
+    const Eigen::Matrix<T, 3, 1, Eigen::DontAlign> &b)
+{
+    double t = (double(slice_z) - double(a.z())) / (double(b.z()) - double(a.z()));
+    // Just clamp the intersection point to source triangle edge.
+    return t <= 0. ? v3f_scaled_to_contour_point(a) :
+           t >= 1. ? v3f_scaled_to_contour_point(b) :
+           v3f_scaled_to_contour_point(a.template head<2>().template cast<double>() * (1. - t) + b.template head<2>().template cast<double>() * t + Vec2d(0.5, 0.5));
+}
+
 // Return true, if the facet has been sliced and line_out has been filled.
 template<typename T>
 inline FacetSliceType slice_facet(
@@ -285,8 +300,8 @@ inline FacetSliceType slice_facet(
                 std::swap(a, b);
             }
             IntersectionPoint &point = points[num_points];
-            double t = (double(slice_z) - double(a->z())) / (double(b->z()) - double(a->z()));
 #if 0
+            double t = (double(slice_z) - double(a->z())) / (double(b->z()) - double(a->z()));
             // If the intersection point falls into one of the end points, mark it with the end point identifier.
             // While this sounds like a good idea, it likely breaks the chaining by logical addresses of the intersection points
             // and the branch for 0 < t < 1 does not guarantee uniqness of the interection point anyways.
@@ -312,11 +327,7 @@ inline FacetSliceType slice_facet(
                 ++ num_points;
             }
 #else
-            // Just clamp the intersection point to source triangle edge.
-            static_cast<Point&>(point) =
-                t <= 0. ? v3f_scaled_to_contour_point(*a) :
-                t >= 1. ? v3f_scaled_to_contour_point(*b) :
-                v3f_scaled_to_contour_point(a->template head<2>().template cast<double>() * (1. - t) + b->template head<2>().template cast<double>() * t + Vec2d(0.5, 0.5));
+            static_cast<Point&>(point) = slice_edge(slice_z, *a, *b);
             point.edge_id = edge_id;
             ++ num_points;
 #endif
@@ -365,6 +376,60 @@ inline FacetSliceType slice_facet(
     return FacetSliceType::NoSlice;
 }
 
+// Batch kernel slicing a facet with a run of slices in a general position, that is with no facet vertex on any of the slices.
+// Then the same two facet edges cross all the slices of the run, thus the facet is classified just once and the intersection
+// points are calculated in blocks of slices by tight loops without branches, which the compiler may vectorize.
+// Produces the same lines as slice_facet(), bit by bit.
+template<typename T>
+inline void slice_facet_run(
+    // Z heights of the slices of the run, all of them strictly between the Z heights of the facet vertices.
+    const T                                        *zs,
+    const size_t                                    num_zs,
+    const Eigen::Matrix<T, 3, 1, Eigen::DontAlign> *vertices,
+    const stl_triangle_vertex_indices              &indices,
+    const Vec3i                                    &edge_ids,
+    const int                                       idx_vertex_lowest,
+    // Lines of the slices of the run.
+    IntersectionLines                              *lines_out)
+{
+    using Vector = Eigen::Matrix<T, 3, 1, Eigen::DontAlign>;
+    struct CrossingEdge {
+        const Vector *a;
+        const Vector *b;
+        int           edge_id;
+    } edges[2];
+    size_t num_edges = 0;
+    // Classify the facet edges the same way and in the same order as slice_facet() does.
+    for (int j = 0; j < 3; ++ j) {
+        int k = (idx_vertex_lowest + j) % 3;
+        int l = (k + 1) % 3;
+        const Vector *a = vertices + k;
+        const Vector *b = vertices + l;
+        if ((a->z() < zs[0] && b->z() > zs[0]) || (b->z() < zs[0] && a->z() > zs[0])) {
+            assert(num_edges < 2);
+            edges[num_edges ++] = indices[k] > indices[l] ? CrossingEdge{ b, a, edge_ids(k) } : CrossingEdge{ a, b, edge_ids(k) };
+        }
+    }
+    assert(num_edges == 2);
+
+    static constexpr const size_t block_size = 16;
+    Point points[2][block_size];
+    for (size_t block_begin = 0; block_begin < num_zs; block_begin += block_size) {
+        const size_t block_end = std::min(num_zs, block_begin + block_size);
+        for (size_t i = 0; i < 2; ++ i)
+            for (size_t slice_id = block_begin; slice_id < block_end; ++ slice_id)
+                points[i][slice_id - block_begin] = slice_edge(zs[slice_id], *edges[i].a, *edges[i].b);
+        for (size_t slice_id = block_begin; slice_id < block_end; ++ slice_id) {
+            IntersectionLine &line = lines_out[slice_id].emplace_back();
+            line.edge_type  = IntersectionLine::FacetEdgeType::General;
+            line.a          = points[1][slice_id - block_begin];
+            line.b          = points[0][slice_id - block_begin];
+            line.edge_a_id  = edges[1].edge_id;
+            line.edge_b_id  = edges[0].edge_id;
+        }
+    }
+}
+
 class LinesMutexes {
 public:
     std::mutex& operator()(size_t slice_id) {
@@ -380,65 +445,158 @@ private:
     std::array<CacheLineAlignedMutex, 64> m_mutexes;
 };
 
+// Transformed vertices of a facet and the range of slices [first_slice, last_slice) intersecting it.
+struct FacetAtZs {
+    stl_vertex  vertices[3];
+    float       min_z;
+    float       max_z;
+    size_t      first_slice;
+    size_t      last_slice;
+};
+
 template<typename TransformVertex>
-void slice_facet_at_zs(
+inline FacetAtZs facet_at_zs(
     // Scaled or unscaled vertices. transform_vertex_fn may scale zs.
     const std::vector<Vec3f>                         &mesh_vertices,
     const TransformVertex                            &transform_vertex_fn,
     const stl_triangle_vertex_indices                &indices,
-    const Vec3i                                      &edge_ids,
     // Scaled or unscaled zs. If vertices have their zs scaled or transform_vertex_fn scales them, then zs have to be scaled as well.
     const std::vector<float>                         &zs,
-    std::vector<IntersectionLines>                   &lines,
-    LinesMutexes                                     &lines_mutex)
+    // Range of slices to search for the intersecting slices.
+    size_t                                            first_slice,
+    size_t                                            last_slice)
 {
-    stl_vertex vertices[3] { transform_vertex_fn(mesh_vertices[indices(0)]), transform_vertex_fn(mesh_vertices[indices(1)]), transform_vertex_fn(mesh_vertices[indices(2)]) };
+    FacetAtZs out { { transform_vertex_fn(mesh_vertices[indices(0)]), transform_vertex_fn(mesh_vertices[indices(1)]), transform_vertex_fn(mesh_vertices[indices(2)]) } };
 
     // find facet extents
-    const float min_z = fminf(vertices[0].z(), fminf(vertices[1].z(), vertices[2].z()));
-    const float max_z = fmaxf(vertices[0].z(), fmaxf(vertices[1].z(), vertices[2].z()));
-    
+    out.min_z = fminf(out.vertices[0].z(), fminf(out.vertices[1].z(), out.vertices[2].z()));
+    out.max_z = fmaxf(out.vertices[0].z(), fmaxf(out.vertices[1].z(), out.vertices[2].z()));
+
     // find layer extents
-    auto min_layer = std::lower_bound(zs.begin(), zs.end(), min_z); // first layer whose slice_z is >= min_z
-    auto max_layer = std::upper_bound(min_layer, zs.end(), max_z); // first layer whose slice_z is > max_z
-    int  idx_vertex_lowest = (vertices[1].z() == min_z) ? 1 : ((vertices[2].z() == min_z) ? 2 : 0);
-    
-    for (auto it = min_layer; it != max_layer; ++ it) {
-        IntersectionLine il;
-        // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
-        if (min_z != max_z && slice_facet(*it, vertices, indices, edge_ids, idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
-            assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
-            size_t slice_id = it - zs.begin();
-            boost::lock_guard<std::mutex> l(lines_mutex(slice_id));
-            lines[slice_id].emplace_back(il);
+    auto min_layer = std::lower_bound(zs.begin() + first_slice, zs.begin() + last_slice, out.min_z); // first layer whose slice_z is >= min_z
+    auto max_layer = std::upper_bound(min_layer, zs.begin() + last_slice, out.max_z); // first layer whose slice_z is > max_z
+    out.first_slice = min_layer - zs.begin();
+    out.last_slice  = max_layer - zs.begin();
+    // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
+    if (out.min_z == out.max_z)
+        out.last_slice = out.first_slice;
+    return out;
+}
+
+inline void slice_facet_at_zs(
+    const FacetAtZs                                  &facet,
+    const stl_triangle_vertex_indices                &indices,
+    const Vec3i                                      &edge_ids,
+    const std::vector<float>                         &zs,
+    std::vector<IntersectionLines>                   &lines)
+{
+    int idx_vertex_lowest = (facet.vertices[1].z() == facet.min_z) ? 1 : ((facet.vertices[2].z() == facet.min_z) ? 2 : 0);
+    auto slice_scalar = [&facet, &indices, &edge_ids, &zs, &lines, idx_vertex_lowest](size_t first_slice, size_t last_slice) {
+        for (size_t slice_id = first_slice; slice_id < last_slice; ++ slice_id) {
+            IntersectionLine il;
+            if (slice_facet(zs[slice_id], facet.vertices, indices, edge_ids, idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
+                assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+                lines[slice_id].emplace_back(il);
+            }
         }
+    };
+    // Short runs are not worth classifying the facet edges up front.
+    static constexpr const size_t min_run = 4;
+    if (facet.last_slice - facet.first_slice < min_run) {
+        slice_scalar(facet.first_slice, facet.last_slice);
+        return;
+    }
+
+    // Slices strictly between the lowest and the middle vertex resp. between the middle and the highest vertex are sliced
+    // by slice_facet_run(), slices touching a vertex are left to slice_facet().
+    const float mid_z = std::max(std::min(facet.vertices[0].z(), facet.vertices[1].z()), std::min(std::max(facet.vertices[0].z(), facet.vertices[1].z()), facet.vertices[2].z()));
+    size_t slice_id = facet.first_slice;
+    for (const auto &[run_min_z, run_max_z] : { std::make_pair(facet.min_z, mid_z), std::make_pair(mid_z, facet.max_z) }) {
+        const size_t run_begin = std::upper_bound(zs.begin() + slice_id,  zs.begin() + facet.last_slice, run_min_z) - zs.begin();
+        const size_t run_end   = std::lower_bound(zs.begin() + run_begin, zs.begin() + facet.last_slice, run_max_z) - zs.begin();
+        slice_scalar(slice_id, run_begin);
+        if (run_end - run_begin < min_run)
+            slice_scalar(run_begin, run_end);
+        else
+            slice_facet_run(zs.data() + run_begin, run_end - run_begin, facet.vertices, indices, edge_ids, idx_vertex_lowest, lines.data() + run_begin);
+        slice_id = run_end;
     }
+    slice_scalar(slice_id, facet.last_slice);
 }
 
-template<typename TransformVertex, typename ThrowOnCancel>
+// Slice all facets with all zs in two phases without locking:
+// 1) Blocks of facets are processed in parallel, each block bins its facets into its own buffers per chunk of slices
+//    the facets intersect. A facet spanning multiple chunks is binned into each of them.
+// 2) Chunks of slices are processed in parallel, each slice being owned by exactly one chunk. A chunk slices the facets
+//    of its bins in the order of the blocks, thus the intersection lines are produced in the order of the facets
+//    and the result is deterministic.
+// Only num_faces facets are sliced, face_index_fn maps [0, num_faces) to facet indices.
+template<typename TransformVertex, typename FaceIndex, typename ThrowOnCancel>
 static inline std::vector<IntersectionLines> slice_make_lines(
     const std::vector<stl_vertex>                   &vertices,
     const TransformVertex                           &transform_vertex_fn,
     const std::vector<stl_triangle_vertex_indices>  &indices,
     const std::vector<Vec3i>                        &face_edge_ids,
+    const size_t                                     num_faces,
+    const FaceIndex                                 &face_index_fn,
     const std::vector<float>                        &zs,
     const ThrowOnCancel                              throw_on_cancel_fn)
 {
     std::vector<IntersectionLines>  lines(zs.size(), IntersectionLines{});
-    LinesMutexes                    lines_mutex;
-    tbb::parallel_for(
-        tbb::blocked_range<int>(0, int(indices.size())),
-        [&vertices, &transform_vertex_fn, &indices, &face_edge_ids, &zs, &lines, &lines_mutex, throw_on_cancel_fn](const tbb::blocked_range<int> &range) {
-            for (int face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
-                if ((face_idx & 0x0ffff) == 0)
-                    throw_on_cancel_fn();
-                slice_facet_at_zs(vertices, transform_vertex_fn, indices[face_idx], face_edge_ids[face_idx], zs, lines, lines_mutex);
+    if (zs.empty() || num_faces == 0)
+        return lines;
+
+    // Chunks of at least 8 slices, as a facet is transformed again for each chunk it is binned to,
+    // and at most 256 chunks to keep the number of bins low.
+    const size_t slices_per_chunk = std::max<size_t>(8, (zs.size() + 255) / 256);
+    const size_t num_chunks       = (zs.size() + slices_per_chunk - 1) / slices_per_chunk;
+    // Blocks of facets, also the granularity of the cancellation checks.
+    const size_t facets_per_block = 0x10000;
+    const size_t num_blocks       = (num_faces + facets_per_block - 1) / facets_per_block;
+
+    // Indices of facets per block and chunk, indexed by block_idx * num_chunks + chunk_idx.
+    std::vector<std::vector<uint32_t>> bins(num_blocks * num_chunks);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks, 1),
+        [&vertices, &transform_vertex_fn, &indices, num_faces, &face_index_fn, &zs, &bins, slices_per_chunk, num_chunks, facets_per_block, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+            for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx) {
+                throw_on_cancel_fn();
+                std::vector<uint32_t> *block_bins = bins.data() + block_idx * num_chunks;
+                for (size_t i = block_idx * facets_per_block; i < std::min(num_faces, (block_idx + 1) * facets_per_block); ++ i) {
+                    const size_t face_idx = face_index_fn(i);
+                    if (FacetAtZs facet = facet_at_zs(vertices, transform_vertex_fn, indices[face_idx], zs, 0, zs.size()); facet.first_slice < facet.last_slice)
+                        for (size_t chunk_idx = facet.first_slice / slices_per_chunk; chunk_idx <= (facet.last_slice - 1) / slices_per_chunk; ++ chunk_idx)
+                            block_bins[chunk_idx].emplace_back(uint32_t(face_idx));
+                }
             }
-        }
-    );
+        });
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_chunks, 1),
+        [&vertices, &transform_vertex_fn, &indices, &face_edge_ids, &zs, &lines, &bins, slices_per_chunk, num_chunks, num_blocks, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+            for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx) {
+                throw_on_cancel_fn();
+                const size_t first_slice = chunk_idx * slices_per_chunk;
+                const size_t last_slice  = std::min(zs.size(), first_slice + slices_per_chunk);
+                for (size_t block_idx = 0; block_idx < num_blocks; ++ block_idx)
+                    for (const uint32_t face_idx : bins[block_idx * num_chunks + chunk_idx])
+                        slice_facet_at_zs(facet_at_zs(vertices, transform_vertex_fn, indices[face_idx], zs, first_slice, last_slice), indices[face_idx], face_edge_ids[face_idx], zs, lines);
+            }
+        });
     return lines;
 }
 
+// Slice all facets with all zs.
+template<typename TransformVertex, typename ThrowOnCancel>
+static inline std::vector<IntersectionLines> slice_make_lines(
+    const std::vector<stl_vertex>                   &vertices,
+    const TransformVertex                           &transform_vertex_fn,
+    const std::vector<stl_triangle_vertex_indices>  &indices,
+    const std::vector<Vec3i>                        &face_edge_ids,
+    const std::vector<float>                        &zs,
+    const ThrowOnCancel                              throw_on_cancel_fn)
+{
+    return slice_make_lines(vertices, transform_vertex_fn, indices, face_edge_ids, indices.size(), [](size_t i) { return i; }, zs, throw_on_cancel_fn);
+}
+
 template<typename TransformVertex, typename FaceFilter>
 static inline IntersectionLines slice_make_lines(
     const std::vector<stl_vertex>                   &mesh_vertices,
@@ -1775,17 +1933,29 @@ std::vector<Polygons> slice_mesh(
     const std::vector<float>         &zs,
     const MeshSlicingParams          &params,
     std::function<void()>             throw_on_cancel)
+{
+    //FIXME facets_edges is likely not needed and quite costly to calculate.
+    // Instead of edge identifiers, one shall use a sorted pair of edge vertex indices.
+    // However facets_edges assigns a single edge ID to two triangles only, thus when factoring facets_edges out, one will have
+    // to make sure that no code relies on it.
+    // Callers slicing the same mesh repeatedly shall pass the face edge IDs cached by TriangleMesh::face_edge_ids().
+    return slice_mesh(mesh, its_face_edge_ids(mesh), zs, params, throw_on_cancel);
+}
+
+std::vector<Polygons> slice_mesh(
+    const indexed_triangle_set       &mesh,
+    const std::vector<Vec3i>         &face_edge_ids,
+    // Unscaled Zs
+    const std::vector<float>         &zs,
+    const MeshSlicingParams          &params,
+    std::function<void()>             throw_on_cancel)
 {
     BOOST_LOG_TRIVIAL(debug) << "slice_mesh to polygons";
-       
+
+    assert(face_edge_ids.size() == mesh.indices.size());
     std::vector<IntersectionLines> lines;
 
     {
-        //FIXME facets_edges is likely not needed and quite costly to calculate.
-        // Instead of edge identifiers, one shall use a sorted pair of edge vertex indices.
-        // However facets_edges assigns a single edge ID to two triangles only, thus when factoring facets_edges out, one will have
-        // to make sure that no code relies on it.
-        std::vector<Vec3i> face_edge_ids = its_face_edge_ids(mesh);
         if (zs.size() <= 1) {
             // It likely is not worthwile to copy the vertices. Apply the transformation in place.
             if (is_identity(params.trafo)) {
@@ -1914,75 +2084,192 @@ std::vector<ExPolygons> slice_mesh_ex(
     const MeshSlicingParamsEx        &params,
     std::function<void()>             throw_on_cancel)
 {
-    std::vector<Polygons> layers_p;
+    return slice_mesh_ex(mesh, its_face_edge_ids(mesh), zs, params, throw_on_cancel);
+}
+
+// Sweep plane slicing with bounded memory, see MeshSlicingParamsEx::sweep_max_lines.
+// The faces are sorted by the first layer they intersect and streamed through a set of active faces,
+// while the layers are sliced in batches of at most max_lines intersection lines, but at least one layer per batch.
+// The intersection lines of a batch are chained into loops and passed to emit_batch(polygons, first_layer)
+// before the next batch is sliced, thus only the intersection lines of a single batch are held in memory.
+template<typename EmitBatch>
+static void slice_mesh_sweep(
+    const indexed_triangle_set       &mesh,
+    const std::vector<Vec3i>         &face_edge_ids,
+    // Unscaled Zs
+    const std::vector<float>         &zs,
+    const MeshSlicingParams          &params,
+    const size_t                      max_lines,
+    std::function<void()>             throw_on_cancel,
+    EmitBatch                         emit_batch)
+{
+    assert(max_lines > 0);
+    const std::vector<stl_vertex> vertices = transform_mesh_vertices_for_slicing(mesh, params.trafo);
+    const auto                    transform_vertex_fn = [](const Vec3f &p) { return p; };
+
+    // 1) Range of layers [face_first_layer, face_last_layer) intersected by each face. Horizontal faces intersect no layer.
+    std::vector<uint32_t> face_first_layer(mesh.indices.size());
+    std::vector<uint32_t> face_last_layer(mesh.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, mesh.indices.size()),
+        [&mesh, &vertices, &transform_vertex_fn, &zs, &face_first_layer, &face_last_layer, throw_on_cancel](const tbb::blocked_range<size_t> &range) {
+            throw_on_cancel();
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                FacetAtZs facet = facet_at_zs(vertices, transform_vertex_fn, mesh.indices[face_idx], zs, 0, zs.size());
+                face_first_layer[face_idx] = uint32_t(facet.first_slice);
+                face_last_layer[face_idx]  = uint32_t(facet.last_slice);
+            }
+        });
+
+    // 2) Upper estimate of the number of intersection lines per layer, and number of faces starting at each layer.
+    std::vector<size_t> layer_lines(zs.size() + 1, 0);
+    std::vector<size_t> layer_faces_start(zs.size() + 1, 0);
+    for (size_t face_idx = 0; face_idx < mesh.indices.size(); ++ face_idx)
+        if (face_first_layer[face_idx] < face_last_layer[face_idx]) {
+            ++ layer_lines[face_first_layer[face_idx]];
+            -- layer_lines[face_last_layer[face_idx]];
+            ++ layer_faces_start[face_first_layer[face_idx] + 1];
+        }
+    size_t num_lines = 0;
+    for (size_t layer_id = 1; layer_id <= zs.size(); ++ layer_id) {
+        layer_lines[layer_id]       += layer_lines[layer_id - 1];
+        layer_faces_start[layer_id] += layer_faces_start[layer_id - 1];
+        num_lines                   += layer_lines[layer_id - 1];
+    }
+    throw_on_cancel();
+
+    if (num_lines <= max_lines) {
+        // All layers fit into a single batch, don't sort the faces.
+        std::vector<IntersectionLines> lines = slice_make_lines(vertices, transform_vertex_fn, mesh.indices, face_edge_ids, zs, throw_on_cancel);
+        throw_on_cancel();
+        emit_batch(make_loops(lines, params, throw_on_cancel), 0);
+        return;
+    }
+
+    // 3) Counting sort of the faces by the first layer they intersect, keeping the order of faces starting at the same layer.
+    std::vector<uint32_t> faces_sorted(layer_faces_start.back());
     {
-        MeshSlicingParams slicing_params(params);
-        if (params.mode == MeshSlicingParams::SlicingMode::PositiveLargestContour)
-            slicing_params.mode = MeshSlicingParams::SlicingMode::Positive;
-        if (params.mode_below == MeshSlicingParams::SlicingMode::PositiveLargestContour)
-            slicing_params.mode_below = MeshSlicingParams::SlicingMode::Positive;
-        layers_p = slice_mesh(mesh, zs, slicing_params, throw_on_cancel);
+        std::vector<size_t> next = layer_faces_start;
+        for (size_t face_idx = 0; face_idx < mesh.indices.size(); ++ face_idx)
+            if (face_first_layer[face_idx] < face_last_layer[face_idx])
+                faces_sorted[next[face_first_layer[face_idx]] ++] = uint32_t(face_idx);
     }
-    
+    throw_on_cancel();
+
+    // 4) Sweep the layers in batches.
+    std::vector<uint32_t> active_faces;
+    size_t                next_face = 0;
+    for (size_t first_layer = 0; first_layer < zs.size();) {
+        size_t last_layer = first_layer;
+        for (size_t batch_lines = 0; last_layer < zs.size() && (last_layer == first_layer || batch_lines + layer_lines[last_layer] <= max_lines); ++ last_layer)
+            batch_lines += layer_lines[last_layer];
+        // Retire the faces below this batch, activate the faces starting inside this batch.
+        // The active faces are kept sorted by their indices, so that the intersection lines are produced in the same order
+        // as if all layers were sliced at once, and make_loops() chains them into the very same polygons.
+        active_faces.erase(std::remove_if(active_faces.begin(), active_faces.end(),
+            [&face_last_layer, first_layer](const uint32_t face_idx) { return face_last_layer[face_idx] <= first_layer; }),
+            active_faces.end());
+        const size_t num_retained = active_faces.size();
+        active_faces.insert(active_faces.end(), faces_sorted.begin() + next_face, faces_sorted.begin() + layer_faces_start[last_layer]);
+        next_face = layer_faces_start[last_layer];
+        std::sort(active_faces.begin() + num_retained, active_faces.end());
+        std::inplace_merge(active_faces.begin(), active_faces.begin() + num_retained, active_faces.end());
+
+        const std::vector<float>       batch_zs(zs.begin() + first_layer, zs.begin() + last_layer);
+        std::vector<IntersectionLines> lines = slice_make_lines(vertices, transform_vertex_fn, mesh.indices, face_edge_ids,
+            active_faces.size(), [&active_faces](size_t i) { return active_faces[i]; }, batch_zs, throw_on_cancel);
+        throw_on_cancel();
+        MeshSlicingParams batch_params(params);
+        batch_params.slicing_mode_normal_below_layer = params.slicing_mode_normal_below_layer > first_layer ? params.slicing_mode_normal_below_layer - first_layer : 0;
+        std::vector<Polygons> polygons = make_loops(lines, batch_params, throw_on_cancel);
+        // Release the intersection lines before the batch is processed further.
+        lines = {};
+        emit_batch(std::move(polygons), first_layer);
+        first_layer = last_layer;
+    }
+}
+
+std::vector<ExPolygons> slice_mesh_ex(
+    const indexed_triangle_set       &mesh,
+    const std::vector<Vec3i>         &face_edge_ids,
+    const std::vector<float>         &zs,
+    const MeshSlicingParamsEx        &params,
+    std::function<void()>             throw_on_cancel)
+{
+    MeshSlicingParams slicing_params(params);
+    if (params.mode == MeshSlicingParams::SlicingMode::PositiveLargestContour)
+        slicing_params.mode = MeshSlicingParams::SlicingMode::Positive;
+    if (params.mode_below == MeshSlicingParams::SlicingMode::PositiveLargestContour)
+        slicing_params.mode_below = MeshSlicingParams::SlicingMode::Positive;
+
+    std::vector<ExPolygons> layers(zs.size(), ExPolygons{});
+    // Convert layers_p sliced at zs starting with first_layer to layers.
+    auto make_layers_expolygons = [&params, &layers, throw_on_cancel](const std::vector<Polygons> &layers_p, const size_t first_layer) {
 //    BOOST_LOG_TRIVIAL(debug) << "slice_mesh make_expolygons in parallel - start";
-    std::vector<ExPolygons> layers(layers_p.size(), ExPolygons{});
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, layers_p.size()),
-        [&layers_p, &params, &layers, throw_on_cancel]
-        (const tbb::blocked_range<size_t>& range) {
-            auto resolution = scaled<float>(params.resolution);
-            for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
-                throw_on_cancel();
-                ExPolygons &expolygons = layers[layer_id];
-                const auto this_mode = layer_id < params.slicing_mode_normal_below_layer ? params.mode_below : params.mode;
-                Slic3r::make_expolygons(
-                    layers_p[layer_id], params.closing_radius, params.extra_offset,
-                    this_mode == MeshSlicingParams::SlicingMode::EvenOdd ? ClipperLib::pftEvenOdd : 
-                    this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour ? ClipperLib::pftPositive : ClipperLib::pftNonZero,
-                    &expolygons);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, layers_p.size()),
+            [&layers_p, first_layer, &params, &layers, throw_on_cancel]
+            (const tbb::blocked_range<size_t>& range) {
+                auto resolution = scaled<float>(params.resolution);
+                for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                    throw_on_cancel();
+                    ExPolygons &expolygons = layers[first_layer + layer_id];
+                    const auto this_mode = first_layer + layer_id < params.slicing_mode_normal_below_layer ? params.mode_below : params.mode;
+                    Slic3r::make_expolygons(
+                        layers_p[layer_id], params.closing_radius, params.extra_offset,
+                        this_mode == MeshSlicingParams::SlicingMode::EvenOdd ? ClipperLib::pftEvenOdd : 
+                        this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour ? ClipperLib::pftPositive : ClipperLib::pftNonZero,
+                        &expolygons);
 
 #if 0
 //#ifndef NDEBUG
-                // Test whether the expolygons in a single layer overlap.
-                for (size_t i = 0; i < expolygons.size(); ++ i)
-                    for (size_t j = i + 1; j < expolygons.size(); ++ j) {
-                        Polygons overlap = intersection(expolygons[i], expolygons[j]);
-                        assert(overlap.empty());
-                    }
+                    // Test whether the expolygons in a single layer overlap.
+                    for (size_t i = 0; i < expolygons.size(); ++ i)
+                        for (size_t j = i + 1; j < expolygons.size(); ++ j) {
+                            Polygons overlap = intersection(expolygons[i], expolygons[j]);
+                            assert(overlap.empty());
+                        }
 #endif
 #if 0
 //#ifndef NDEBUG
-                for (const ExPolygon &ex : expolygons) {
-                    assert(! has_duplicate_points(ex.contour));
-                    for (const Polygon &hole : ex.holes)
-                        assert(! has_duplicate_points(hole));
-                    assert(! has_duplicate_points(ex));
-                }
-                assert(!has_duplicate_points(expolygons));
+                    for (const ExPolygon &ex : expolygons) {
+                        assert(! has_duplicate_points(ex.contour));
+                        for (const Polygon &hole : ex.holes)
+                            assert(! has_duplicate_points(hole));
+                        assert(! has_duplicate_points(ex));
+                    }
+                    assert(!has_duplicate_points(expolygons));
 #endif // NDEBUG
-                //FIXME simplify
-                if (this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour)
-                    keep_largest_contour_only(expolygons);
-                if (resolution != 0.) {
-                    ExPolygons simplified;
-                    simplified.reserve(expolygons.size());
-                    for (const ExPolygon &ex : expolygons)
-                        append(simplified, ex.simplify(resolution));
-                    expolygons = std::move(simplified);
-                }
+                    //FIXME simplify
+                    if (this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour)
+                        keep_largest_contour_only(expolygons);
+                    if (resolution != 0.) {
+                        ExPolygons simplified;
+                        simplified.reserve(expolygons.size());
+                        for (const ExPolygon &ex : expolygons)
+                            append(simplified, ex.simplify(resolution));
+                        expolygons = std::move(simplified);
+                    }
 #if 0
 //#ifndef NDEBUG
-                for (const ExPolygon &ex : expolygons) {
-                    assert(! has_duplicate_points(ex.contour));
-                    for (const Polygon &hole : ex.holes)
-                        assert(! has_duplicate_points(hole));
-                    assert(! has_duplicate_points(ex));
-                }
-                assert(! has_duplicate_points(expolygons));
+                    for (const ExPolygon &ex : expolygons) {
+                        assert(! has_duplicate_points(ex.contour));
+                        for (const Polygon &hole : ex.holes)
+                            assert(! has_duplicate_points(hole));
+                        assert(! has_duplicate_points(ex));
+                    }
+                    assert(! has_duplicate_points(expolygons));
 #endif // NDEBUG
-            }
-        });
+                }
+            });
 //    BOOST_LOG_TRIVIAL(debug) << "slice_mesh make_expolygons in parallel - end";
+    };
+
+    if (params.sweep_max_lines == 0 || zs.empty())
+        make_layers_expolygons(slice_mesh(mesh, face_edge_ids, zs, slicing_params, throw_on_cancel), 0);
+    else {
+        BOOST_LOG_TRIVIAL(debug) << "slice_mesh_ex sweeping " << zs.size() << " layers";
+        slice_mesh_sweep(mesh, face_edge_ids, zs, slicing_params, params.sweep_max_lines, throw_on_cancel, make_layers_expolygons);
+    }
 
     return layers;
 }
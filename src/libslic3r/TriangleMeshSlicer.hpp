@@ -56,6 +56,11 @@ struct MeshSlicingParamsEx : public MeshSlicingParams
     // Resolution for contour simplification, unscaled.
     // 0 = don't simplify.
     double        resolution { 0 };
+    // Sweep plane slicing of huge meshes with bounded memory: slice_mesh_ex() slices the layers in batches
+    // of at most this number of intersection lines (at least a single layer per batch), each batch is turned
+    // into expolygons before the next batch is sliced. The result is the same as if all layers were sliced at once.
+    // 0 = slice all layers at once.
+    size_t        sweep_max_lines { 0 };
 };
 
 // All the following slicing functions shall produce consistent results with the same mesh, same transformation matrix and slicing parameters.
@@ -75,6 +80,14 @@ std::vector<Polygons>           slice_mesh(
     const MeshSlicingParams          &params,
     std::function<void()>             throw_on_cancel = []{});
 
+// Variant of slice_mesh() reusing face edge IDs precalculated by its_face_edge_ids(mesh), for example cached by TriangleMesh::face_edge_ids().
+std::vector<Polygons>           slice_mesh(
+    const indexed_triangle_set       &mesh,
+    const std::vector<Vec3i>         &face_edge_ids,
+    const std::vector<float>         &zs,
+    const MeshSlicingParams          &params,
+    std::function<void()>             throw_on_cancel = []{});
+
 // Specialized version for a single slicing plane only, running on a single thread.
 Polygons                        slice_mesh(
     const indexed_triangle_set       &mesh,
@@ -87,6 +100,14 @@ std::vector<ExPolygons>         slice_mesh_ex(
     const MeshSlicingParamsEx        &params,
     std::function<void()>             throw_on_cancel = []{});
 
+// Variant of slice_mesh_ex() reusing face edge IDs precalculated by its_face_edge_ids(mesh), for example cached by TriangleMesh::face_edge_ids().
+std::vector<ExPolygons>         slice_mesh_ex(
+    const indexed_triangle_set       &mesh,
+    const std::vector<Vec3i>         &face_edge_ids,
+    const std::vector<float>         &zs,
+    const MeshSlicingParamsEx        &params,
+    std::function<void()>             throw_on_cancel = []{});
+
 inline std::vector<ExPolygons>  slice_mesh_ex(
     const indexed_triangle_set       &mesh,
     const std::vector<float>         &zs,
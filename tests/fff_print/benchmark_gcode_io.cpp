@@ -0,0 +1,96 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <catch2/catch.hpp>
+
+#include <charconv>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fast_float.h>
+
+#include "libslic3r/GCode/GCodeWriter.hpp"
+#include "libslic3r/GCodeReader.hpp"
+
+using namespace Slic3r;
+
+namespace {
+
+std::vector<Vec3d> random_extrusion_moves(size_t count)
+{
+    std::mt19937                           rng(42);
+    std::uniform_real_distribution<double> xy(-125., 125.);
+    std::uniform_real_distribution<double> e(0., 2.);
+    std::vector<Vec3d>                     moves(count);
+    for (Vec3d &move : moves)
+        move = Vec3d(xy(rng), xy(rng), e(rng));
+    return moves;
+}
+
+// Formatting of a scaled integer by std::to_chars, which was used by GCodeFormatter::emit_axis() before.
+char* emit_axis_to_chars(char *ptr, char *end, char axis, double v, size_t digits)
+{
+    *ptr ++ = ' ';
+    *ptr ++ = axis;
+    return std::to_chars(ptr, end, int64_t(std::round(v * GCodeFormatter::pow_10[digits]))).ptr;
+}
+
+} // namespace
+
+TEST_CASE("G-code number formatting and parsing benchmarks", "[GCodeWriter][.Benchmarks]") {
+    const std::vector<Vec3d> moves = random_extrusion_moves(100000);
+
+    BENCHMARK("Format G1 lines with GCodeG1Formatter") {
+        size_t size = 0;
+        for (const Vec3d &move : moves) {
+            GCodeG1Formatter formatter;
+            formatter.emit_xy(move.head<2>());
+            formatter.emit_e("E", move.z());
+            size += formatter.string().size();
+        }
+        return size;
+    };
+
+    BENCHMARK("Format G1 lines with std::to_chars") {
+        size_t size = 0;
+        char   buf[256];
+        for (const Vec3d &move : moves) {
+            char *ptr = buf;
+            *ptr ++ = 'G'; *ptr ++ = '1';
+            ptr = emit_axis_to_chars(ptr, buf + sizeof(buf), 'X', move.x(), GCodeFormatter::XYZF_EXPORT_DIGITS);
+            ptr = emit_axis_to_chars(ptr, buf + sizeof(buf), 'Y', move.y(), GCodeFormatter::XYZF_EXPORT_DIGITS);
+            ptr = emit_axis_to_chars(ptr, buf + sizeof(buf), 'E', move.z(), GCodeFormatter::E_EXPORT_DIGITS);
+            *ptr ++ = '\n';
+            size += std::string(buf, ptr).size();
+        }
+        return size;
+    };
+
+    std::string gcode;
+    for (const Vec3d &move : moves) {
+        GCodeG1Formatter formatter;
+        formatter.emit_xy(move.head<2>());
+        formatter.emit_e("E", move.z());
+        gcode += formatter.string();
+    }
+
+    BENCHMARK("Parse G1 lines with GCodeReader") {
+        GCodeReader reader;
+        float       sum = 0.f;
+        reader.parse_buffer(gcode, [&sum](GCodeReader &, const GCodeReader::GCodeLine &line) { sum += line.x() + line.y() + line.e(); });
+        return sum;
+    };
+
+    BENCHMARK("Parse G1 axis values with fast_float") {
+        double sum = 0.;
+        for (const char *ptr = gcode.c_str(), *end = ptr + gcode.size(); ptr != end; ++ ptr)
+            if (*ptr == 'X' || *ptr == 'Y' || *ptr == 'E') {
+                double v;
+                ptr = fast_float::from_chars(ptr + 1, end, v).ptr - 1;
+                sum += v;
+            }
+        return sum;
+    };
+}
@@ -6,6 +6,9 @@
 #include "libslic3r/libslic3r.h"
 
 #include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/EdgeGrid.hpp"
+#include "libslic3r/Fill/FillAdaptive.hpp"
+#include "libslic3r/Fill/Lightning/Layer.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Layer.hpp"
 #include "libslic3r/Geometry.hpp"
@@ -13,6 +16,7 @@
 #include "libslic3r/Point.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SVG.hpp"
+#include "libslic3r/TriangleMesh.hpp"
 
 #include "test_data.hpp"
 
@@ -663,6 +667,125 @@ SCENARIO("Infill density zero", "[Fill]")
 }
 */
 
+// Horizontal squares at the given Zs triangulated the way PrintObject triangulates the internal bridges, rotated to the octree.
+static std::vector<Vec3d> adaptive_overhang_triangles(const std::vector<std::pair<double, double>> &x_z)
+{
+    const Eigen::Matrix3d to_octree = FillAdaptive::transform_to_octree().toRotationMatrix();
+    std::vector<Vec3d>    out;
+    for (const auto &[x, z] : x_z)
+        for (const Vec3d &p : { Vec3d(x, -5., z), Vec3d(x + 10., -5., z), Vec3d(x + 10., 5., z), Vec3d(x, -5., z), Vec3d(x + 10., 5., z), Vec3d(x, 5., z) })
+            out.emplace_back(to_octree * p);
+    return out;
+}
+
+SCENARIO("Adaptive cubic octree rebuilt from an old octree", "[Fill]")
+{
+    GIVEN("Sphere with internal overhangs") {
+        indexed_triangle_set mesh = its_make_sphere(25., PI / 64.);
+        its_transform(mesh, Matrix3d(FillAdaptive::transform_to_octree().toRotationMatrix()));
+        std::vector<std::pair<double, double>> overhangs_x_z;
+        for (int i = 0; i < 40; ++ i)
+            overhangs_x_z.emplace_back(-15., -20. + i);
+        const std::vector<Vec3d> overhangs = adaptive_overhang_triangles(overhangs_x_z);
+        // Move the overhangs of a quarter of the layers.
+        for (int i = 10; i < 20; ++ i)
+            overhangs_x_z[i].first = 3.;
+        const std::vector<Vec3d> overhangs_changed = adaptive_overhang_triangles(overhangs_x_z);
+
+        for (const bool support_overhangs_only : { false, true }) {
+            // The octree built once does not record the hashes of its cubes, its rebuild does not reuse anything yet.
+            const FillAdaptive::OctreePtr first_octree = FillAdaptive::build_octree(mesh, overhangs, 1., support_overhangs_only);
+            const FillAdaptive::OctreePtr old_octree   = FillAdaptive::build_octree(mesh, overhangs, 1., support_overhangs_only, first_octree.get());
+            REQUIRE(FillAdaptive::octrees_equal(*old_octree, *first_octree));
+            REQUIRE(FillAdaptive::octree_num_reused_cubes(*old_octree) == 0);
+            WHEN(std::string("Octree is rebuilt with part of the overhangs changed, ") + (support_overhangs_only ? "support cubic" : "adaptive cubic")) {
+                const FillAdaptive::OctreePtr octree       = FillAdaptive::build_octree(mesh, overhangs_changed, 1., support_overhangs_only, old_octree.get());
+                const FillAdaptive::OctreePtr from_scratch = FillAdaptive::build_octree(mesh, overhangs_changed, 1., support_overhangs_only);
+                THEN("Octree matches the octree built from scratch, unchanged subtrees are reused") {
+                    REQUIRE(FillAdaptive::octrees_equal(*octree, *from_scratch));
+                    REQUIRE(FillAdaptive::octree_num_reused_cubes(*octree) > 0);
+                    REQUIRE(FillAdaptive::octree_num_reused_cubes(*octree) < FillAdaptive::octree_num_cubes(*octree) - 1);
+                }
+                THEN("Octree rebuilt from the rebuilt octree with the original overhangs matches the octree built from scratch") {
+                    const FillAdaptive::OctreePtr octree2 = FillAdaptive::build_octree(mesh, overhangs, 1., support_overhangs_only, octree.get());
+                    REQUIRE(FillAdaptive::octrees_equal(*octree2, *old_octree));
+                    REQUIRE(FillAdaptive::octree_num_reused_cubes(*octree2) > 0);
+                }
+            }
+            WHEN(std::string("Octree is rebuilt with the same triangles, ") + (support_overhangs_only ? "support cubic" : "adaptive cubic")) {
+                const FillAdaptive::OctreePtr octree = FillAdaptive::build_octree(mesh, overhangs, 1., support_overhangs_only, old_octree.get());
+                THEN("All cubes but the root are copied") {
+                    REQUIRE(FillAdaptive::octrees_equal(*octree, *old_octree));
+                    REQUIRE(FillAdaptive::octree_num_reused_cubes(*octree) == FillAdaptive::octree_num_cubes(*octree) - 1);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Lightning infill trees stored in per layer node pools", "[Fill]")
+{
+    GIVEN("Cylinder with holes closing at different heights") {
+        // Generate the trees from the top to the bottom the way FillLightning::Generator does.
+        const int             num_layers             = 40;
+        const coord_t         layer_thickness        = scaled<coord_t>(0.2);
+        const coord_t         supporting_radius      = scaled<coord_t>(3.);
+        std::vector<Polygons> outlines(num_layers);
+        for (int layer_id = 0; layer_id < num_layers; ++ layer_id) {
+            Polygons holes;
+            for (int i = 0; i < 4; ++ i)
+                if (layer_id > 8 * i + 5) {
+                    Polygon hole = Polygon::new_scale({ { -3., -3. }, { 3., -3. }, { 3., 3. }, { -3., 3. } });
+                    hole.translate(Point::new_scale(10. * cos(i * PI / 2.), 10. * sin(i * PI / 2.)));
+                    holes.emplace_back(std::move(hole));
+                }
+            outlines[layer_id] = diff(Polygons{ Polygon::new_scale({ { -20., -20. }, { 20., -20. }, { 20., 20. }, { -20., 20. } }) }, holes);
+        }
+        std::vector<FillLightning::Layer> layers(num_layers);
+        EdgeGrid::Grid outlines_locator(get_extents(outlines.back()).inflated(SCALED_EPSILON));
+        outlines_locator.create(outlines.back(), FillLightning::locator_cell_size);
+        for (int layer_id = num_layers - 1; layer_id >= 0; -- layer_id) {
+            FillLightning::Layer &layer    = layers[layer_id];
+            const BoundingBox     bbox     = get_extents(outlines[layer_id]);
+            const Polygons        overhang = diff(offset(outlines[layer_id], -float(layer_thickness)), layer_id + 1 == num_layers ? Polygons() : outlines[layer_id + 1]);
+            std::vector<FillLightning::NodeIdx> to_be_reconnected_tree_roots = layer.tree_roots;
+            layer.generateNewTrees(overhang, outlines[layer_id], bbox, outlines_locator, supporting_radius, layer_thickness, []() {});
+            layer.reconnectRoots(to_be_reconnected_tree_roots, outlines[layer_id], bbox, outlines_locator, supporting_radius, layer_thickness);
+            if (layer_id > 0) {
+                BoundingBox below_bbox = get_extents(outlines[layer_id - 1]).inflated(SCALED_EPSILON);
+                below_bbox.merge(outlines_locator.bbox());
+                below_bbox.merge(get_extents(layer.nodes, layer.tree_roots).inflated(SCALED_EPSILON));
+                outlines_locator.set_bbox(below_bbox);
+                outlines_locator.create(outlines[layer_id - 1], FillLightning::locator_cell_size);
+                for (FillLightning::NodeIdx tree : layer.tree_roots)
+                    layer.nodes.propagateToNextLayer(tree, layers[layer_id - 1].nodes, layers[layer_id - 1].tree_roots, outlines[layer_id - 1], outlines_locator,
+                        layer_thickness, layer_thickness, FillLightning::locator_cell_size / 2);
+            }
+        }
+        THEN("Each pool holds just the nodes of the trees of its layer, the nodes dropped from the trees are released") {
+            for (const FillLightning::Layer &layer : layers) {
+                size_t num_nodes   = 0;
+                bool   links_valid = true;
+                for (FillLightning::NodeIdx tree : layer.tree_roots) {
+                    links_valid &= layer.nodes[tree].isRoot();
+                    layer.nodes.visitNodes(tree, [&layer, &num_nodes, &links_valid](FillLightning::NodeIdx node) {
+                        ++ num_nodes;
+                        for (FillLightning::NodeIdx child : layer.nodes[node].children())
+                            links_valid &= ! layer.nodes[child].isRoot() && layer.nodes[child].parent() == node;
+                    });
+                }
+                REQUIRE(links_valid);
+                REQUIRE(num_nodes == layer.nodes.size());
+            }
+        }
+        THEN("Trees are propagated down to the first layer and converted to lines") {
+            REQUIRE(! layers.front().tree_roots.empty());
+            for (int layer_id = 0; layer_id < num_layers; ++ layer_id)
+                REQUIRE(! layers[layer_id].convertToLines(outlines[layer_id], scaled<coord_t>(0.1)).empty());
+        }
+    }
+}
+
 bool test_if_solid_surface_filled(const ExPolygon& expolygon, double flow_spacing, double angle, double density)
 {
     std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type("rectilinear"));
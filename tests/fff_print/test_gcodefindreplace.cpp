@@ -1,6 +1,10 @@
 #include <catch2/catch.hpp>
 
 #include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string/replace.hpp>
 
 #include "libslic3r/GCode/FindReplace.hpp"
 
@@ -290,3 +294,91 @@ SCENARIO("Find/Replace with regexp", "[GCodeFindReplace]") {
         }
     }
 }
+
+SCENARIO("Find/Replace with multiple plain text rules", "[GCodeFindReplace]") {
+    GIVEN("G-code") {
+        const std::string gcode =
+            "M104 S200\n"
+            "M140 S60\n"
+            "G1 Z1; move up\n"
+            "M106 S255\n"
+            "G1 X13 Y32 Z1; infill\n"
+            "M107\n";
+        WHEN("Independent rules are applied") {
+            GCodeFindReplace find_replace({ "M104", "M109", "", "", "M140", "M190", "", "", "M106 S255", "M106 S200", "", "", "; infill", "", "", "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "M109 S200\n"
+                "M190 S60\n"
+                "G1 Z1; move up\n"
+                "M106 S200\n"
+                "G1 X13 Y32 Z1\n"
+                "M107\n");
+        }
+        WHEN("Rule is applied to the output of the previous rule") {
+            GCodeFindReplace find_replace({ "M104", "M140", "", "", "M140", "M190", "", "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "M190 S200\n"
+                "M190 S60\n"
+                "G1 Z1; move up\n"
+                "M106 S255\n"
+                "G1 X13 Y32 Z1; infill\n"
+                "M107\n");
+        }
+        WHEN("Previous rule destroys a match of the following rule") {
+            GCodeFindReplace find_replace({ "M10", "M20", "", "", "M104 S200", "M109 S210", "", "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "M204 S200\n"
+                "M140 S60\n"
+                "G1 Z1; move up\n"
+                "M206 S255\n"
+                "G1 X13 Y32 Z1; infill\n"
+                "M207\n");
+        }
+        WHEN("Following rule matches across the replacement of the previous rule") {
+            GCodeFindReplace find_replace({ "Z1; move up", "Z1", "", "", "Z1\nM106", "Z1\nM107", "", "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "M104 S200\n"
+                "M140 S60\n"
+                "G1 Z1\n"
+                "M107 S255\n"
+                "G1 X13 Y32 Z1; infill\n"
+                "M107\n");
+        }
+        WHEN("Plain text rules are mixed with regexp and whole word rules") {
+            GCodeFindReplace find_replace({ "M104", "M109", "", "", "M140", "M190", "", "", "S([0-9]+)", "S${1}0", "r", "", "Z1", "Z2", "w", "", "M107", "M106 S0", "", "", "M106", "M106 P1", "", "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "M109 S2000\n"
+                "M190 S600\n"
+                "G1 Z2; move up\n"
+                "M106 P1 S2550\n"
+                "G1 X13 Y32 Z2; infill\n"
+                "M106 P1 S0\n");
+        }
+    }
+}
+
+TEST_CASE("Find/Replace benchmarks", "[GCodeFindReplace][.Benchmarks]") {
+    std::vector<std::string> substitutions;
+    for (int i = 0; i < 24; ++ i)
+        substitutions.insert(substitutions.end(), { "M" + std::to_string(700 + i) + " ", "M" + std::to_string(800 + i) + " ", "", "" });
+    std::string gcode;
+    for (int i = 0; i < 100000; ++ i)
+        gcode += "G1 X" + std::to_string(i % 997) + ".123 Y" + std::to_string(i % 991) + ".456 E0.0123\n" + (i % 1000 == 0 ? "M710 S1\n" : "");
+
+    // One pass over the G-code per substitution, as GCodeFindReplace did before the plain text substitutions were merged.
+    auto replace_one_by_one = [&substitutions](std::string gcode) {
+        for (size_t i = 0; i < substitutions.size(); i += 4)
+            boost::replace_all(gcode, substitutions[i], substitutions[i + 1]);
+        return gcode;
+    };
+
+    GCodeFindReplace find_replace(substitutions);
+    REQUIRE(find_replace.process_layer(gcode) == replace_one_by_one(gcode));
+
+    BENCHMARK("GCodeFindReplace::process_layer() with 24 plain text substitutions") {
+        return find_replace.process_layer(gcode);
+    };
+    BENCHMARK("boost::replace_all() with 24 plain text substitutions") {
+        return replace_one_by_one(gcode);
+    };
+}
@@ -32,3 +32,31 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+SCENARIO("GCodeFormatter emits fixed-point values without redundant digits.", "[GCodeWriter]") {
+    auto emit = [](double v, size_t digits) {
+        GCodeG1Formatter formatter;
+        formatter.emit_axis('X', v, digits);
+        return formatter.string();
+    };
+    GIVEN("Values formatted with XYZF_EXPORT_DIGITS") {
+        THEN("Trailing zeros and the decimal point of integers are omitted") {
+            REQUIRE_THAT(emit(12.5, GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 X12.5\n"));
+            REQUIRE_THAT(emit(-100., GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 X-100\n"));
+        }
+        THEN("The leading zero of values below one is omitted") {
+            REQUIRE_THAT(emit(0.25, GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 X.25\n"));
+            REQUIRE_THAT(emit(-0.0625, GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 X-.063\n"));
+        }
+        THEN("Values rounding to zero are emitted as zero") {
+            REQUIRE_THAT(emit(0., GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 X0\n"));
+            REQUIRE_THAT(emit(-0.0004, GCodeFormatter::XYZF_EXPORT_DIGITS), Catch::Equals("G1 X0\n"));
+        }
+    }
+    GIVEN("Values formatted with E_EXPORT_DIGITS") {
+        THEN("Values are rounded to the nearest representable value") {
+            REQUIRE_THAT(emit(1.000006, GCodeFormatter::E_EXPORT_DIGITS), Catch::Equals("G1 X1.00001\n"));
+            REQUIRE_THAT(emit(-0.123456, GCodeFormatter::E_EXPORT_DIGITS), Catch::Equals("G1 X-.12346\n"));
+        }
+    }
+}
@@ -0,0 +1,97 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <oneapi/tbb/parallel_pipeline.h>
+
+#include "libslic3r/GCode/PipelineStats.hpp"
+
+using namespace Slic3r;
+
+namespace {
+
+struct Layer
+{
+    size_t      id { 0 };
+    std::string gcode;
+};
+
+} // namespace
+
+SCENARIO("G-code export pipeline statistics", "[GCode]") {
+    GIVEN("A pipeline of a source, a parallel and a serial filter, and a filter not chained into the pipeline") {
+        constexpr size_t num_layers = 50;
+        GCode::PipelineStats stats;
+        size_t               next_layer = 0;
+        const auto source = tbb::make_filter<void, Layer>(tbb::filter_mode::serial_in_order,
+            stats.instrument<void, Layer>("source", [&next_layer](tbb::flow_control &fc) -> Layer {
+                if (next_layer == num_layers) {
+                    fc.stop();
+                    return {};
+                }
+                return { next_layer ++ };
+            }));
+        const auto generate = tbb::make_filter<Layer, Layer>(tbb::filter_mode::parallel,
+            stats.instrument<Layer, Layer>("generate", [](Layer in) -> Layer {
+                in.gcode = "G1 X" + std::to_string(in.id) + "\n";
+                return in;
+            }));
+        const auto unused = tbb::make_filter<Layer, Layer>(tbb::filter_mode::serial_in_order,
+            stats.instrument<Layer, Layer>("unused", [](Layer in) -> Layer { return in; }));
+        std::string output;
+        const auto sink = tbb::make_filter<Layer, void>(tbb::filter_mode::serial_in_order,
+            stats.instrument<Layer, void>("output", [&output](Layer in) { output += in.gcode; }));
+        tbb::parallel_pipeline(4, source & generate & sink);
+
+        WHEN("The statistics are reported") {
+            const std::string report = stats.report(4);
+            boost::property_tree::ptree tree;
+            std::istringstream          is(report);
+            REQUIRE_NOTHROW(boost::property_tree::read_json(is, tree));
+            THEN("The report is a single line") {
+                REQUIRE(report.find('\n') == std::string::npos);
+            }
+            THEN("The pipeline parameters are reported") {
+                REQUIRE(tree.get<double>("wall_ms") > 0.);
+                REQUIRE(tree.get<size_t>("tokens") == 4);
+            }
+            THEN("The stages of the pipeline are reported in order, the unused filter is skipped") {
+                std::vector<std::string> names;
+                for (const auto &stage : tree.get_child("stages"))
+                    names.emplace_back(stage.second.get<std::string>("name"));
+                REQUIRE(names == std::vector<std::string>{ "source", "generate", "output" });
+            }
+            THEN("Each stage processed all layers, the call stopping the pipeline is not counted") {
+                for (const auto &stage : tree.get_child("stages"))
+                    REQUIRE(stage.second.get<size_t>("items") == num_layers);
+            }
+            THEN("The G-code bytes produced by the parallel filter and consumed by the output are counted") {
+                std::vector<size_t> bytes;
+                for (const auto &stage : tree.get_child("stages"))
+                    bytes.emplace_back(stage.second.get<size_t>("bytes"));
+                REQUIRE(bytes == std::vector<size_t>{ 0, output.size(), output.size() });
+            }
+            THEN("Busy time, utilization and stalls are reported, stalls only after the source") {
+                const double wall_ms = tree.get<double>("wall_ms");
+                for (const auto &stage : tree.get_child("stages")) {
+                    const double busy_ms = stage.second.get<double>("busy_ms");
+                    REQUIRE(busy_ms >= 0.);
+                    REQUIRE(stage.second.get<double>("utilization") == Approx(busy_ms / wall_ms).epsilon(1e-3));
+                    const bool is_source = stage.second.get<std::string>("name") == "source";
+                    REQUIRE(bool(stage.second.get_optional<double>("stall_ms")) == ! is_source);
+                    REQUIRE(bool(stage.second.get_optional<double>("avg_queue")) == ! is_source);
+                    if (! is_source)
+                        REQUIRE(stage.second.get<double>("stall_ms") >= 0.);
+                }
+            }
+        }
+    }
+}
@@ -280,6 +280,147 @@ SCENARIO( "TriangleMesh: Mesh merge functions") {
     }
 }
 
+SCENARIO( "TriangleMesh: Cached topology") {
+    GIVEN( "A 20mm cube with one corner on the origin") {
+        auto cube = make_cube();
+        std::shared_ptr<const std::vector<Vec3i>> face_edge_ids = cube.face_edge_ids();
+        THEN( "Cached face edge IDs match the freshly calculated ones.") {
+            REQUIRE(*face_edge_ids == its_face_edge_ids(cube.its));
+            REQUIRE(*cube.face_neighbors() == its_face_neighbors(cube.its));
+        }
+        THEN( "Topology is calculated just once.") {
+            REQUIRE(cube.face_edge_ids() == face_edge_ids);
+        }
+        WHEN( "The mesh is translated") {
+            cube.translate(1.f, 2.f, 3.f);
+            THEN( "Topology is reused.") {
+                REQUIRE(cube.face_edge_ids() == face_edge_ids);
+            }
+        }
+        WHEN( "The mesh is flipped") {
+            cube.flip_triangles();
+            THEN( "Topology is recalculated.") {
+                REQUIRE(cube.face_edge_ids() != face_edge_ids);
+                REQUIRE(*cube.face_edge_ids() == its_face_edge_ids(cube.its));
+            }
+            THEN( "Flipped face neighbors match the cached ones flipped.") {
+                std::vector<Vec3i> face_neighbors = its_face_neighbors(make_cube().its);
+                its_flip_face_edges(face_neighbors);
+                REQUIRE(*cube.face_neighbors() == face_neighbors);
+            }
+        }
+        WHEN( "The indices are modified in place from the outside and the topology is invalidated") {
+            std::swap(cube.its.indices.front()(1), cube.its.indices.front()(2));
+            std::swap(cube.its.indices.back(), cube.its.indices.front());
+            cube.invalidate_topology();
+            THEN( "Topology is recalculated.") {
+                REQUIRE(cube.face_edge_ids() != face_edge_ids);
+                REQUIRE(*cube.face_edge_ids() == its_face_edge_ids(cube.its));
+                REQUIRE(*cube.face_neighbors() == its_face_neighbors(cube.its));
+            }
+        }
+        WHEN( "The indices are replaced by a new buffer") {
+            std::vector<stl_triangle_vertex_indices> indices = make_cube().its.indices;
+            std::reverse(indices.begin(), indices.end());
+            cube.its.indices = std::move(indices);
+            THEN( "Topology is recalculated.") {
+                REQUIRE(cube.face_edge_ids() != face_edge_ids);
+                REQUIRE(*cube.face_edge_ids() == its_face_edge_ids(cube.its));
+            }
+        }
+        WHEN( "Faces are added to the indices") {
+            cube.its.indices.emplace_back(cube.its.indices.front());
+            THEN( "Topology is recalculated.") {
+                REQUIRE(cube.face_edge_ids()->size() == cube.its.indices.size());
+            }
+        }
+        WHEN( "The mesh is merged with another mesh") {
+            cube.merge(make_cube());
+            THEN( "Topology is recalculated.") {
+                REQUIRE(cube.face_edge_ids()->size() == cube.its.indices.size());
+            }
+        }
+        WHEN( "The mesh is sliced with the cached face edge IDs") {
+            std::vector<float> zs { 5.f, 10.f, 15.f };
+            THEN( "The slices match the slices made without the cache.") {
+                std::vector<ExPolygons> slices = slice_mesh_ex(cube.its, *face_edge_ids, zs, MeshSlicingParamsEx{});
+                REQUIRE(slices == slice_mesh_ex(cube.its, zs));
+            }
+        }
+        WHEN( "Optional data are released") {
+            THEN( "Memory of the cached topology is reported.") {
+                REQUIRE(cube.release_optional() > 0);
+                REQUIRE(cube.face_edge_ids() != face_edge_ids);
+            }
+        }
+    }
+}
+
+// Slices the mesh in batches of layers of various sizes, the slices shall be the same as if all layers were sliced at once,
+// the same contours with the same points in the same order.
+static void require_sweep_slices_equal(const TriangleMesh &mesh, const std::vector<float> &zs, MeshSlicingParamsEx params)
+{
+    const std::vector<ExPolygons> slices = slice_mesh_ex(mesh.its, zs, params);
+    for (size_t sweep_max_lines : { 1, 50, 500 }) {
+        params.sweep_max_lines = sweep_max_lines;
+        const std::vector<ExPolygons> slices_sweep = slice_mesh_ex(mesh.its, zs, params);
+        REQUIRE(slices_sweep.size() == slices.size());
+        for (size_t i = 0; i < slices.size(); ++ i)
+            REQUIRE(slices_sweep[i] == slices[i]);
+    }
+}
+
+SCENARIO( "TriangleMeshSlicer: Sweep plane slicing.") {
+    GIVEN( "A sphere and a cube side by side") {
+        TriangleMesh mesh = make_sphere(10., 2. * PI / 60.);
+        mesh.merge(make_cube());
+        std::vector<float> zs;
+        for (float z = -9.95f; z < 20.f; z += 0.1f)
+            zs.emplace_back(z);
+        THEN( "The slices made in batches of layers match the slices made at once.") {
+            require_sweep_slices_equal(mesh, zs, {});
+        }
+        THEN( "The slices made in batches of layers match the slices made at once with a different slicing mode of the first layers.") {
+            MeshSlicingParamsEx params;
+            params.slicing_mode_normal_below_layer = 20;
+            params.mode_below = MeshSlicingParams::SlicingMode::Positive;
+            require_sweep_slices_equal(mesh, zs, params);
+        }
+    }
+    GIVEN( "A step with horizontal facets at the slicing planes") {
+        TriangleMesh mesh = Slic3r::Test::mesh(Slic3r::Test::TestMesh::step);
+        // Horizontal facets at 0, 5 and 10 mm.
+        std::vector<float> zs;
+        for (int i = 0; i <= 20; ++ i)
+            zs.emplace_back(0.5f * float(i));
+        THEN( "The slices made in batches of layers match the slices made at once.") {
+            require_sweep_slices_equal(mesh, zs, {});
+        }
+    }
+    GIVEN( "A 20mm cube sliced at its bottom and top faces") {
+        TriangleMesh mesh = make_cube();
+        std::vector<float> zs;
+        for (int i = 0; i <= 20; ++ i)
+            zs.emplace_back(float(i));
+        THEN( "The slices made in batches of layers match the slices made at once.") {
+            MeshSlicingParamsEx params;
+            params.closing_radius = 0.1f;
+            params.resolution     = 0.01;
+            require_sweep_slices_equal(mesh, zs, params);
+        }
+    }
+    GIVEN( "A cube with a sloping hole") {
+        TriangleMesh mesh = Slic3r::Test::mesh(Slic3r::Test::TestMesh::sloping_hole);
+        const BoundingBoxf3 bbox = mesh.bounding_box();
+        std::vector<float> zs;
+        for (float z = float(bbox.min.z()); z <= float(bbox.max.z()); z += 0.25f)
+            zs.emplace_back(z);
+        THEN( "The slices made in batches of layers match the slices made at once.") {
+            require_sweep_slices_equal(mesh, zs, {});
+        }
+    }
+}
+
 SCENARIO( "TriangleMeshSlicer: Cut behavior.") {
     GIVEN( "A 20mm cube with one corner on the origin") {
 		auto cube = make_cube();
@@ -0,0 +1,66 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Arachne/WallToolPaths.hpp"
+
+using namespace Slic3r;
+
+static Polygon gear(int teeth, double r_root, double r_tip)
+{
+    Polygon poly;
+    for (int i = 0; i < 4 * teeth; ++i) {
+        const double angle  = 2. * PI * i / (4 * teeth);
+        const double radius = i % 4 < 2 ? r_tip : r_root;
+        poly.points.emplace_back(scaled<coord_t>(radius * cos(angle)), scaled<coord_t>(radius * sin(angle)));
+    }
+    return poly;
+}
+
+static size_t generate_wall_tool_paths(const Polygons &polygons, coord_t spacing, coord_t inset_count, const PrintObjectConfig &print_object_config)
+{
+    Arachne::WallToolPaths wall_tool_paths(polygons, spacing, spacing, inset_count, 0, 0.2, print_object_config, PrintConfig::defaults());
+    wall_tool_paths.generate();
+    size_t num_junctions = 0;
+    for (const Arachne::VariableWidthLines &lines : wall_tool_paths.getToolPaths())
+        for (const Arachne::ExtrusionLine &line : lines)
+            num_junctions += line.size();
+    return num_junctions;
+}
+
+// The skeletal trapezoidation graph is built for each island of each layer.
+TEST_CASE("Arachne benchmarks", "[Arachne][.Benchmarks]") {
+    Polygons gears { gear(60, 18., 20.), gear(24, 6., 7.) };
+    gears.back().reverse();
+    for (int i = 0; i < 5; ++i) {
+        Polygon hole = gear(8, 1.5, 2.);
+        hole.translate(scaled<coord_t>(11. * cos(0.4 * PI * i)), scaled<coord_t>(11. * sin(0.4 * PI * i)));
+        hole.reverse();
+        gears.emplace_back(std::move(hole));
+    }
+
+    // Polygon from "Arachne - #8593 - Missing a part of the extrusion".
+    const Polygons polygons_8593 = { Polygon {
+        Point( 1800000, 28500000),
+        Point( 1100000, 30000000),
+        Point( 1000000, 30900000),
+        Point(  600000, 32300000),
+        Point( -600000, 32300000),
+        Point(-1000000, 30900000),
+        Point(-1100000, 30000000),
+        Point(-1800000, 29000000),
+    } };
+    PrintObjectConfig print_object_config_8593 = PrintObjectConfig::defaults();
+    print_object_config_8593.min_bead_width         = ConfigOptionFloatOrPercent(0.315, false);
+    print_object_config_8593.wall_transition_angle  = ConfigOptionFloat(40.);
+    print_object_config_8593.wall_transition_length = ConfigOptionFloatOrPercent(1., false);
+
+    BENCHMARK("WallToolPaths::generate() of gears") {
+        return generate_wall_tool_paths(gears, 437079, 5, PrintObjectConfig::defaults());
+    };
+    BENCHMARK("WallToolPaths::generate() of #8593") {
+        return generate_wall_tool_paths(polygons_8593, 377079, 3, print_object_config_8593);
+    };
+}
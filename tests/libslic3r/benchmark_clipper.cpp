@@ -0,0 +1,105 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include <oneapi/tbb/blocked_range.h>
+#include <oneapi/tbb/parallel_for.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+
+using namespace Slic3r;
+
+namespace {
+
+// Results of the ClipperUtils calls replayed for a single layer.
+struct LayerOutput
+{
+    std::vector<ExPolygons> expolygons;
+    Polygons                polygons;
+    Polylines               polylines;
+
+    bool operator==(const LayerOutput &rhs) const { return expolygons == rhs.expolygons && polygons == rhs.polygons && polylines == rhs.polylines; }
+};
+
+// Replays the ClipperUtils calls made for a single layer by the perimeter generator, by the detection of overhangs
+// and by the infill generator on the slices of a real model.
+LayerOutput replay_layer(const ExPolygons &below, const ExPolygons &layer, const ExPolygons &above)
+{
+    const float spacing = scaled<float>(0.45);
+    LayerOutput out;
+
+    // Perimeters.
+    ExPolygons last = offset_ex(layer, -0.5f * spacing);
+    for (int i = 0; i < 3 && ! last.empty(); ++ i) {
+        out.expolygons.emplace_back(last);
+        last = offset2_ex(last, - spacing - 0.05f * spacing, 0.05f * spacing);
+    }
+    ExPolygons infill_area = opening_ex(last, 0.5f * spacing);
+    out.expolygons.emplace_back(infill_area);
+
+    // Overhangs and top surfaces.
+    out.expolygons.emplace_back(diff_ex(layer, offset(below, spacing)));
+    append(out.polygons, diff(to_polygons(layer), to_polygons(above), ApplySafetyOffset::Yes));
+    out.expolygons.emplace_back(intersection_ex(infill_area, above));
+    out.expolygons.emplace_back(union_ex(to_polygons(layer), to_polygons(above)));
+    out.expolygons.emplace_back(closing_ex(layer, spacing));
+
+    // Infill lines clipped by the infill area.
+    if (! infill_area.empty()) {
+        const BoundingBox bbox = get_extents(infill_area);
+        Polylines         lines;
+        for (coord_t x = bbox.min.x(); x < bbox.max.x(); x += coord_t(2. * spacing))
+            lines.push_back({ { x, bbox.min.y() }, { x, bbox.max.y() } });
+        out.polylines = intersection_pl(lines, infill_area);
+    }
+    return out;
+}
+
+std::vector<LayerOutput> replay_layers(const std::vector<ExPolygons> &layers, bool with_clipper_context)
+{
+    std::vector<LayerOutput> out(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&layers, with_clipper_context, &out](const tbb::blocked_range<size_t> &range) {
+        std::optional<ClipperUtils::ClipperContext> clipper_context;
+        if (with_clipper_context)
+            clipper_context.emplace();
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            out[i] = replay_layer(layers[i == 0 ? 0 : i - 1], layers[i], layers[std::min(i + 1, layers.size() - 1)]);
+    });
+    return out;
+}
+
+void benchmark_clipper(const std::string &name, const std::vector<ExPolygons> &layers)
+{
+    // The results of each layer shall not depend on the reuse of the Clipper engines.
+    const std::vector<LayerOutput> reference = replay_layers(layers, false);
+    const std::vector<LayerOutput> reused    = replay_layers(layers, true);
+    REQUIRE(reused.size() == reference.size());
+    for (size_t i = 0; i < layers.size(); ++ i)
+        REQUIRE(reused[i] == reference[i]);
+    for_each_thread_count({ 1, 4, 16 }, [&name, &layers](size_t threads) {
+        const std::string label = name + ", " + std::to_string(layers.size()) + " layers, " + std::to_string(threads) + " threads";
+        BENCHMARK(label + ", without ClipperContext") {
+            return replay_layers(layers, false);
+        };
+        BENCHMARK(label + ", with ClipperContext") {
+            return replay_layers(layers, true);
+        };
+    });
+}
+
+} // namespace
+
+TEST_CASE("ClipperUtils benchmarks", "[ClipperUtils][.Benchmarks]") {
+    for (const std::string &obj : benchmark_models) {
+        const indexed_triangle_set its = load_model(obj).its;
+        benchmark_clipper(obj, slice_mesh_ex(its, slicing_grid(its, 0.2f)));
+    }
+}
@@ -0,0 +1,38 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <string>
+
+#include "libslic3r/TriangleMesh.hpp"
+
+using namespace Slic3r;
+
+TEST_CASE("STL loading benchmarks", "[stl][.Benchmarks]") {
+    // Sphere of radius 50mm generated by its_make_sphere(): An icosahedron is subdivided until the edges are shorter than
+    // 0.003 * radius, that is 9 times, producing 20 * 4^9 = 5'242'880 triangles.
+    const boost::filesystem::path temp = boost::filesystem::unique_path();
+    REQUIRE(its_write_stl_binary(temp.string().c_str(), "sphere", its_make_sphere(50., 0.003)));
+    const std::string path = temp.string();
+
+    BENCHMARK("admesh stl_open() + stl_check_facets_exact()") {
+        stl_file stl;
+        stl_open(&stl, path.c_str());
+        stl_check_facets_exact(&stl);
+        return stl.stats.connected_edges;
+    };
+    for_each_thread_count([&path](size_t threads) {
+        BENCHMARK("stl_open_mapped() + stl_check_facets_exact_parallel(), " + std::to_string(threads) + " threads") {
+            stl_file stl;
+            stl_open_mapped(&stl, path.c_str());
+            stl_check_facets_exact_parallel(&stl);
+            return stl.stats.connected_edges;
+        };
+    });
+    boost::nowide::remove(path.c_str());
+}
@@ -0,0 +1,65 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "libslic3r/PresetBundle.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/Utils.hpp"
+
+using namespace Slic3r;
+
+// Configuration definitions and the defaults of the static configurations are built at application start.
+TEST_CASE("Print config startup benchmarks", "[Config][.Benchmarks]") {
+    BENCHMARK("PrintConfigDef construction") {
+        PrintConfigDef def;
+        return def.options.size();
+    };
+    BENCHMARK("DynamicPrintConfig::full_print_config()") {
+        return DynamicPrintConfig::full_print_config().size();
+    };
+    BENCHMARK("FullPrintConfig option lookup by name") {
+        const FullPrintConfig &config = FullPrintConfig::defaults();
+        size_t found = 0;
+        for (const std::string &key : config.keys_ref())
+            found += config.option(key) != nullptr;
+        return found;
+    };
+}
+
+// The configuration part of the application startup end to end: The print config definition, a preset bundle
+// with the system presets of the largest vendor profile and the full config of the selected presets.
+// The application loads the system presets from the config bundle cache, if it is valid.
+TEST_CASE("Print config and presets startup benchmarks", "[Config][.Benchmarks]") {
+    const std::string             old_data_dir = data_dir();
+    const boost::filesystem::path tmp_data_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("prusaslicer_tests_%%%%-%%%%-%%%%");
+    set_data_dir(tmp_data_dir.string());
+    const std::string bundle_path = std::string(TEST_DATA_DIR) + "/../../resources/profiles/PrusaResearch.ini";
+
+    auto startup = [&bundle_path](PresetBundle::LoadConfigBundleAttributes flags) {
+        PrintConfigDef def;
+        PresetBundle   bundle;
+        bundle.load_configbundle(bundle_path, flags, ForwardCompatibilitySubstitutionRule::Disable);
+        return def.options.size() + bundle.full_config().size();
+    };
+    BENCHMARK("PrintConfigDef + PrusaResearch.ini parsed + PresetBundle::full_config()") {
+        return startup(PresetBundle::LoadSystem);
+    };
+    // Create the cache.
+    startup(PresetBundle::LoadSystem | PresetBundle::UseCache);
+    BENCHMARK("PrintConfigDef + PrusaResearch.ini from cache + PresetBundle::full_config()") {
+        return startup(PresetBundle::LoadSystem | PresetBundle::UseCache);
+    };
+    BENCHMARK("PresetBundle construction") {
+        PresetBundle bundle;
+        return bundle.prints.size();
+    };
+
+    boost::filesystem::remove_all(tmp_data_dir);
+    set_data_dir(old_data_dir);
+}
@@ -0,0 +1,41 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include <string>
+#include <vector>
+
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+
+using namespace Slic3r;
+
+namespace {
+
+void benchmark_slice_mesh(const std::string &name, const indexed_triangle_set &its, float layer_height)
+{
+    const std::vector<float> zs = slicing_grid(its, layer_height);
+    for_each_thread_count([&name, &its, &zs](size_t threads) {
+        BENCHMARK(name + ", " + std::to_string(its.indices.size()) + " triangles, " + std::to_string(zs.size()) + " layers, " + std::to_string(threads) + " threads") {
+            return slice_mesh(its, zs, MeshSlicingParams{});
+        };
+    });
+}
+
+} // namespace
+
+TEST_CASE("Mesh slicing benchmarks", "[TriangleMeshSlicer][.Benchmarks]") {
+    for (const std::string &obj : benchmark_models)
+        benchmark_slice_mesh(obj, load_model(obj).its, 0.05f);
+
+    // Two spheres of 5.2M triangles each, the icosahedron is subdivided 9 times.
+    indexed_triangle_set spheres = its_make_sphere(50., 0.003);
+    indexed_triangle_set sphere2 = spheres;
+    for (stl_vertex &v : sphere2.vertices)
+        v.x() += 120.f;
+    its_merge(spheres, std::move(sphere2));
+    benchmark_slice_mesh("two spheres", spheres, 0.05f);
+}
@@ -3,6 +3,7 @@
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/3mf.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/miniz_extension.hpp"
 
 #include <boost/filesystem/operations.hpp>
 
@@ -80,6 +81,79 @@ SCENARIO("Export+Import geometry to/from 3mf file cycle", "[3mf]") {
     }
 }
 
+SCENARIO("Export+Import of large meshes to/from 3mf file cycle", "[3mf]") {
+    GIVEN("a model with meshes spanning several chunks of a model file large enough to be inflated on a worker thread") {
+        Model src_model;
+        // 163842 vertices and 327680 triangles, that is several chunks of 32k vertices resp. triangles deflated in parallel.
+        src_model.add_object("sphere", "", TriangleMesh(its_make_sphere(50., 2. * PI / 600.)));
+        // A second object, thus the chunks of the sphere are followed by text and by chunks of another object.
+        src_model.add_object("cube", "", TriangleMesh(its_make_cube(20., 20., 20.)));
+        src_model.add_default_instances();
+        REQUIRE(src_model.objects.front()->volumes.front()->mesh().its.vertices.size() > 4 * 32 * 1024);
+
+        WHEN("model is saved+loaded to/from 3mf file") {
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/chunks.3mf";
+            bool stored = store_3mf(test_file.c_str(), &src_model, nullptr, false);
+
+            // Decompress all the archive entries and verify their CRC32.
+            mz_zip_error error = MZ_ZIP_NO_ERROR;
+            bool valid = mz_zip_validate_file_archive(test_file.c_str(), 0, &error);
+            // Size of the model file once inflated.
+            mz_uint64 model_file_size = 0;
+            {
+                mz_zip_archive archive;
+                mz_zip_zero_struct(&archive);
+                if (open_zip_reader(&archive, test_file)) {
+                    if (int idx = mz_zip_reader_locate_file(&archive, "3D/3dmodel.model", nullptr, 0); idx >= 0) {
+                        mz_zip_archive_file_stat stat;
+                        if (mz_zip_reader_file_stat(&archive, mz_uint(idx), &stat))
+                            model_file_size = stat.m_uncomp_size;
+                    }
+                    close_zip_reader(&archive);
+                }
+            }
+
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            bool loaded;
+            {
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                loaded = load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false);
+            }
+            boost::filesystem::remove(test_file);
+
+            THEN("the archive is valid") {
+                REQUIRE(stored);
+                REQUIRE(valid);
+                REQUIRE(error == MZ_ZIP_NO_ERROR);
+            }
+            THEN("the model file is inflated on a worker thread when loaded") {
+                // MODEL_INFLATE_ASYNC_MIN_SIZE of 3mf.cpp
+                REQUIRE(model_file_size >= 4 * 1024 * 1024);
+            }
+            THEN("load succeeds and vertices and triangles are identical") {
+                REQUIRE(loaded);
+                REQUIRE(dst_model.objects.size() == src_model.objects.size());
+                for (size_t i = 0; i < src_model.objects.size(); ++ i) {
+                    REQUIRE(dst_model.objects[i]->volumes.size() == 1);
+                    // The 3MF stores the vertices transformed by the volume matrix, the loader centers the volume the same way
+                    // Model::add_object() does, thus the vertices are compared with the stored vertices centered by Model::add_object().
+                    const ModelVolume    &src_volume = *src_model.objects[i]->volumes.front();
+                    indexed_triangle_set  stored_its = src_volume.mesh().its;
+                    for (stl_vertex &v : stored_its.vertices)
+                        v = (src_volume.get_matrix() * v.cast<double>()).cast<float>();
+                    Model expected_model;
+                    expected_model.add_object("", "", TriangleMesh(std::move(stored_its)));
+                    const ModelVolume          &expected_volume = *expected_model.objects.front()->volumes.front();
+                    const ModelVolume          &dst_volume      = *dst_model.objects[i]->volumes.front();
+                    REQUIRE(dst_volume.mesh().its.indices == src_volume.mesh().its.indices);
+                    REQUIRE(dst_volume.mesh().its.vertices == expected_volume.mesh().its.vertices);
+                }
+            }
+        }
+    }
+}
+
 SCENARIO("2D convex hull of sinking object", "[3mf]") {
     GIVEN("model") {
         // load a model
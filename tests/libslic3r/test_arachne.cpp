@@ -847,3 +847,47 @@ TEST_CASE("Arachne - SPE-2298 - Missing twin edge - 2", "[ArachneMissingTwinEdge
 
     REQUIRE(!perimeters.empty());
 }
+
+TEST_CASE("Arachne - WallToolPathsCache reuses toolpaths of the same outline", "[ArachneWallToolPathsCache]") {
+    const Polygon poly_0 = {
+        Point(-38768167, -3636556),
+        Point(-38763631, -3617883),
+        Point(-38763925, -3617820),
+        Point(-38990169, -3919539),
+        Point(-38928506, -3919539),
+    };
+
+    const Polygon poly_1 = {
+        Point(-39521732, -4480560),
+        Point(-39383333, -4398498),
+        Point(-39119825, -3925307),
+        Point(-39165608, -3926212),
+        Point(-39302205, -3959445),
+        Point(-39578719, -4537002),
+    };
+
+    Polygons polygons    = {poly_0, poly_1};
+    coord_t  spacing     = 407079;
+    coord_t  inset_count = 2;
+
+    Arachne::WallToolPaths wall_tool_paths(polygons, spacing, spacing, inset_count, 0, 0.2, PrintObjectConfig::defaults(), PrintConfig::defaults());
+    const std::vector<Arachne::VariableWidthLines> &perimeters = wall_tool_paths.getToolPaths();
+
+    Arachne::WallToolPathsCache cache;
+    Arachne::WallToolPathsCache::ResultPtr result = cache.generate(polygons, spacing, spacing, inset_count, 0, 0.2, PrintObjectConfig::defaults(), PrintConfig::defaults());
+    REQUIRE(result->toolpaths.size() == perimeters.size());
+    for (size_t perimeter_idx = 0; perimeter_idx < perimeters.size(); ++perimeter_idx) {
+        REQUIRE(result->toolpaths[perimeter_idx].size() == perimeters[perimeter_idx].size());
+        for (size_t line_idx = 0; line_idx < perimeters[perimeter_idx].size(); ++line_idx)
+            CHECK(result->toolpaths[perimeter_idx][line_idx].junctions == perimeters[perimeter_idx][line_idx].junctions);
+    }
+    CHECK(result->inner_contour == wall_tool_paths.getInnerContour());
+
+    CHECK(cache.generate(polygons, spacing, spacing, inset_count, 0, 0.2, PrintObjectConfig::defaults(), PrintConfig::defaults()) == result);
+    CHECK(cache.generate(polygons, spacing, spacing, inset_count + 1, 0, 0.2, PrintObjectConfig::defaults(), PrintConfig::defaults()) != result);
+
+    Polygons polygons_translated = polygons;
+    for (Polygon &polygon : polygons_translated)
+        polygon.translate(Point(1, 0));
+    CHECK(cache.generate(polygons_translated, spacing, spacing, inset_count, 0, 0.2, PrintObjectConfig::defaults(), PrintConfig::defaults()) != result);
+}
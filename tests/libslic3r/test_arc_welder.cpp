@@ -3,6 +3,8 @@
 
 #include <random>
 
+#include <libslic3r/ExtrusionEntityCollection.hpp>
+#include <libslic3r/GCode/SmoothPath.hpp>
 #include <libslic3r/Geometry/ArcWelder.hpp>
 #include <libslic3r/Geometry/Circle.hpp>
 #include <libslic3r/SVG.hpp>
@@ -508,3 +510,65 @@ TEST_CASE("arc quantization", "[ArcWelder]") {
     }
 }
 #endif
+
+TEST_CASE("smooth paths of unchanged layers reused between exports", "[ArcWelder]") {
+    using namespace Slic3r::Geometry;
+
+    auto make_layer = [](coord_t radius) {
+        Polyline circle;
+        for (int i = 0; i <= 64; ++ i) {
+            double a = 2. * M_PI * i / 64;
+            circle.points.emplace_back(coord_t(radius * cos(a)), coord_t(radius * sin(a)));
+        }
+        ExtrusionEntityCollection layer;
+        layer.append(ExtrusionLoop({ ExtrusionPath(circle, ExtrusionAttributes{ ExtrusionRole::ExternalPerimeter }) }));
+        layer.append(ExtrusionPath(Polyline({ { 0, 0 }, { radius / 2, 10 }, { radius, 0 } }), ExtrusionAttributes{ ExtrusionRole::InternalInfill }));
+        return layer;
+    };
+    auto paths_of = [](const ExtrusionEntityCollection &layer) {
+        std::vector<const ExtrusionPath*> out;
+        out.emplace_back(&static_cast<const ExtrusionLoop*>(layer.entities[0])->paths.front());
+        out.emplace_back(static_cast<const ExtrusionPath*>(layer.entities[1]));
+        return out;
+    };
+
+    const GCode::SmoothPathCache::InterpolationParameters params { scaled<double>(0.01), scaled<double>(0.05) };
+    GCode::SmoothPathLayerCache layer_cache;
+    const ExtrusionEntityCollection first_export = make_layer(scaled<coord_t>(10.));
+    GCode::SmoothPathCache          first_cache;
+    layer_cache.interpolate_add({ &first_export }, params, first_cache);
+    layer_cache.release_unused();
+
+    GIVEN("The same layer allocated again by the next export") {
+        const ExtrusionEntityCollection second_export = make_layer(scaled<coord_t>(10.));
+        GCode::SmoothPathCache          second_cache;
+        layer_cache.interpolate_add({ &second_export }, params, second_cache);
+        THEN("The smooth paths of the first export are resolved for the new extrusion paths") {
+            for (size_t i = 0; i < 2; ++ i) {
+                const ArcWelder::Path *first  = first_cache.resolve(*paths_of(first_export)[i]);
+                const ArcWelder::Path *second = second_cache.resolve(*paths_of(second_export)[i]);
+                REQUIRE(first != nullptr);
+                REQUIRE(second != nullptr);
+                REQUIRE(*first == *second);
+            }
+        }
+    }
+    GIVEN("A changed layer and changed interpolation parameters") {
+        const ExtrusionEntityCollection changed = make_layer(scaled<coord_t>(12.));
+        GCode::SmoothPathCache::InterpolationParameters params_no_arcs { params.tolerance, 0. };
+        GCode::SmoothPathCache changed_cache, changed_params_cache;
+        layer_cache.interpolate_add({ &changed }, params, changed_cache);
+        layer_cache.interpolate_add({ &first_export }, params_no_arcs, changed_params_cache);
+        THEN("The smooth paths are interpolated again") {
+            for (size_t i = 0; i < 2; ++ i) {
+                const ExtrusionPath &path = *paths_of(changed)[i];
+                GCode::SmoothPathCache expected;
+                expected.interpolate_add(path, params);
+                REQUIRE(*changed_cache.resolve(path) == *expected.resolve(path));
+                const ExtrusionPath &path_no_arcs = *paths_of(first_export)[i];
+                expected.interpolate_add(path_no_arcs, params_no_arcs);
+                REQUIRE(*changed_params_cache.resolve(path_no_arcs) == *expected.resolve(path_no_arcs));
+            }
+        }
+    }
+}
@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 
 #include <numeric>
+#include <tuple>
 #include <iostream>
 #include <boost/filesystem.hpp>
 
@@ -382,3 +383,28 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+TEST_CASE("Reusing Clipper engines by ClipperContext", "[ClipperUtils]") {
+    Polygon    square { { 0, 0 }, { 2000000, 0 }, { 2000000, 2000000 }, { 0, 2000000 } };
+    Polygon    hole   { { 500000, 500000 }, { 500000, 1500000 }, { 1500000, 1500000 }, { 1500000, 500000 } };
+    ExPolygons subject { ExPolygon(square, hole) };
+    Polygons   clip   { Polygon { { 1000000, -500000 }, { 3000000, -500000 }, { 3000000, 1000000 }, { 1000000, 1000000 } } };
+    Polylines  lines  { Polyline { { -100000, 1000000 }, { 2100000, 1000000 } }, Polyline { { 1000000, -100000 }, { 1000000, 2100000 } } };
+
+    auto run = [&]() {
+        return std::make_tuple(offset_ex(subject, -100000.f), offset(subject, 100000.f), diff_ex(subject, clip), intersection(to_polygons(subject), clip),
+            union_ex(to_polygons(subject), clip), opening_ex(subject, 200000.f), intersection_pl(lines, subject));
+    };
+    const auto reference = run();
+    ClipperUtils::ClipperContext clipper_context;
+    REQUIRE(ClipperUtils::ClipperContext::current() == &clipper_context);
+    // The second round reuses the engines released by the first one.
+    REQUIRE(run() == reference);
+    REQUIRE(run() == reference);
+    {
+        ClipperUtils::ClipperContext nested;
+        REQUIRE(ClipperUtils::ClipperContext::current() == &nested);
+        REQUIRE(run() == reference);
+    }
+    REQUIRE(ClipperUtils::ClipperContext::current() == &clipper_context);
+}
@@ -2,6 +2,8 @@
 
 #include "libslic3r/Config.hpp"
 #include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/PresetBundle.hpp"
+#include "libslic3r/Utils.hpp"
 
 #include <LocalesUtils.hpp>
 #include <cereal/types/polymorphic.hpp>
@@ -9,6 +11,9 @@
 #include <cereal/types/vector.hpp> 
 #include <cereal/archives/binary.hpp>
 
+#include <boost/filesystem/operations.hpp>
+#include <boost/nowide/fstream.hpp>
+
 using namespace Slic3r;
 
 TEST_CASE("Dynamic config serialization - tests ConfigBase", "[Config]"){
@@ -481,4 +486,99 @@ SCENARIO("DynamicPrintConfig serialization", "[Config]") {
             REQUIRE(cfg == cfg2);
         }
     }
+
+    WHEN("serialized DynamicPrintConfig contains an unknown serialization key ordinal") {
+        std::string serialized;
+        {
+            std::ostringstream ss;
+            cereal::BinaryOutputArchive oarchive(ss);
+            oarchive(size_t(1), std::numeric_limits<size_t>::max());
+            serialized = ss.str();
+        }
+        THEN("deserialization throws") {
+            DynamicPrintConfig cfg;
+            std::stringstream ss(serialized);
+            cereal::BinaryInputArchive iarchive(ss);
+            REQUIRE_THROWS_AS(iarchive(cfg), cereal::Exception);
+        }
+    }
+}
+
+// System presets of a loaded PresetBundle are equal.
+static bool system_presets_equal(const PresetBundle &lhs, const PresetBundle &rhs)
+{
+    auto collection_equal = [](const PresetCollection &lhs, const PresetCollection &rhs) {
+        if (lhs.size() != rhs.size())
+            return false;
+        for (size_t i = 0; i < lhs.size(); ++ i) {
+            const Preset &l = lhs.preset(i);
+            const Preset &r = rhs.preset(i);
+            if (l.name != r.name || l.is_system != r.is_system || l.alias != r.alias || l.renamed_from != r.renamed_from || ! (l.config == r.config))
+                return false;
+        }
+        return true;
+    };
+    auto vendors_equal = [](const VendorMap &lhs, const VendorMap &rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const auto &l, const auto &r) {
+            return l.first == r.first && l.second.config_version == r.second.config_version && l.second.models.size() == r.second.models.size();
+        });
+    };
+    return collection_equal(lhs.prints, rhs.prints) && collection_equal(lhs.filaments, rhs.filaments) && collection_equal(lhs.printers, rhs.printers) &&
+        vendors_equal(lhs.vendors, rhs.vendors);
+}
+
+SCENARIO("Config bundle cache", "[Config]") {
+    // The cache is stored into the data directory.
+    const std::string             old_data_dir = data_dir();
+    const boost::filesystem::path tmp_data_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("prusaslicer_tests_%%%%-%%%%-%%%%");
+    set_data_dir(tmp_data_dir.string());
+    const std::string             bundle_path  = std::string(TEST_DATA_DIR) + "/../../resources/profiles/Print4Taste.ini";
+    const boost::filesystem::path cache_path   = tmp_data_dir / "cache" / "presets" / "Print4Taste.bin";
+
+    PresetBundle parsed;
+    parsed.load_configbundle(bundle_path, PresetBundle::LoadSystem, ForwardCompatibilitySubstitutionRule::Disable);
+
+    GIVEN("system config bundle loaded with the cache enabled") {
+        PresetBundle first;
+        first.load_configbundle(bundle_path, PresetBundle::LoadSystem | PresetBundle::UseCache, ForwardCompatibilitySubstitutionRule::Disable);
+        REQUIRE(boost::filesystem::exists(cache_path));
+        const uintmax_t cache_size = boost::filesystem::file_size(cache_path);
+        REQUIRE(system_presets_equal(first, parsed));
+
+        WHEN("config bundle is loaded from the cache") {
+            PresetBundle cached;
+            cached.load_configbundle(bundle_path, PresetBundle::LoadSystem | PresetBundle::UseCache, ForwardCompatibilitySubstitutionRule::Disable);
+            THEN("presets match the presets parsed from the config bundle") {
+                REQUIRE(system_presets_equal(cached, parsed));
+            }
+        }
+        WHEN("the cache is truncated") {
+            boost::filesystem::resize_file(cache_path, cache_size / 2);
+            PresetBundle cached;
+            cached.load_configbundle(bundle_path, PresetBundle::LoadSystem | PresetBundle::UseCache, ForwardCompatibilitySubstitutionRule::Disable);
+            THEN("config bundle is parsed and the cache is rebuilt") {
+                REQUIRE(system_presets_equal(cached, parsed));
+                REQUIRE(boost::filesystem::file_size(cache_path) == cache_size);
+            }
+        }
+        WHEN("the cache is corrupted") {
+            {
+                // Damage the presets in the second half of the file, keeping the cache key intact.
+                boost::nowide::fstream fs(cache_path.string(), std::ios::in | std::ios::out | std::ios::binary);
+                for (uintmax_t pos = cache_size / 2; pos < cache_size; pos += 97) {
+                    fs.seekp(std::streamoff(pos));
+                    fs.put(char(0x5a));
+                }
+            }
+            PresetBundle cached;
+            cached.load_configbundle(bundle_path, PresetBundle::LoadSystem | PresetBundle::UseCache, ForwardCompatibilitySubstitutionRule::Disable);
+            THEN("config bundle is parsed and the cache is rebuilt") {
+                REQUIRE(system_presets_equal(cached, parsed));
+                REQUIRE(boost::filesystem::file_size(cache_path) == cache_size);
+            }
+        }
+    }
+
+    boost::filesystem::remove_all(tmp_data_dir);
+    set_data_dir(old_data_dir);
 }
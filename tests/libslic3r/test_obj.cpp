@@ -0,0 +1,63 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Format/objparser.hpp"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <sstream>
+#include <string>
+
+using namespace ObjParser;
+
+SCENARIO("Parsing an OBJ file in chunks", "[obj]") {
+	GIVEN("an OBJ file of several chunks with relative indices, materials, groups and no line end at the end of the file") {
+		// 300x300 grid of vertices, every other row of the faces references the vertices relatively to the end of the vertex list.
+		const int   n = 300;
+		std::string obj = "# grid\nmtllib grid.mtl\no grid\n";
+		for (int i = 0; i < n; ++ i)
+			for (int j = 0; j < n; ++ j) {
+				obj += "v " + std::to_string(0.1 * i) + " " + std::to_string(0.1 * j) + " " + std::to_string(0.01 * ((i * j) % 7)) + ((i + j) % 2 ? "\r\n" : "\n");
+				if (j % 3 == 0)
+					obj += "vn 0 0 1\nvt 0.5 0.5\n";
+			}
+		for (int i = 0; i + 1 < n; ++ i) {
+			if (i % 50 == 0)
+				obj += "usemtl material" + std::to_string(i) + "\ng group" + std::to_string(i) + "\ns " + std::to_string(i) + "\n";
+			for (int j = 0; j + 1 < n; ++ j) {
+				const int a = i * n + j + 1;
+				obj += i % 2 ?
+					"f " + std::to_string(a) + "/1/1 " + std::to_string(a + n) + "//2 " + std::to_string(a + n + 1) + "\n" :
+					"\tf -1/-1/-1  -2 -3//-2\n";
+			}
+			obj += "v 1 2 3\nvn 1 0 0\nvt 1 1\n";
+		}
+		obj += "o last\nf -1 -2 -3";
+		boost::filesystem::path temp = boost::filesystem::unique_path();
+		{
+			boost::nowide::ofstream file(temp.string(), std::ios::binary);
+			file << obj;
+		}
+		WHEN("the file is parsed") {
+			ObjData data_file;
+			bool    ok = objparse(temp.string().c_str(), data_file);
+			boost::nowide::remove(temp.string().c_str());
+			THEN("the result matches parsing the file line by line from a stream") {
+				// The stream parser requires the last line to be terminated.
+				std::istringstream stream(obj + "\n");
+				ObjData            data_stream;
+				REQUIRE(ok);
+				REQUIRE(objparse(stream, data_stream));
+				REQUIRE(objequal(data_file, data_stream));
+				REQUIRE(data_file.smoothingGroups == data_stream.smoothingGroups);
+				REQUIRE(data_file.coordinates.size() == 4 * (n * n + n - 1));
+				REQUIRE(data_file.objects.size() == 2);
+			}
+		}
+	}
+}
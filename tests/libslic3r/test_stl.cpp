@@ -2,6 +2,12 @@
 
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <cstring>
 
 using namespace Slic3r;
 
@@ -55,3 +61,85 @@ SCENARIO("Reading an STL file", "[stl]") {
 		}
 	}
 }
+
+static bool stl_equal(const stl_file &a, const stl_file &b)
+{
+	if (a.facet_start.size() != b.facet_start.size() || a.neighbors_start.size() != b.neighbors_start.size())
+		return false;
+	for (size_t i = 0; i < a.facet_start.size(); ++ i)
+		if (memcmp(&a.facet_start[i], &b.facet_start[i], SIZEOF_STL_FACET) != 0)
+			return false;
+	for (size_t i = 0; i < a.neighbors_start.size(); ++ i)
+		for (int j = 0; j < 3; ++ j)
+			if (a.neighbors_start[i].neighbor[j] != b.neighbors_start[i].neighbor[j] ||
+				a.neighbors_start[i].which_vertex_not[j] != b.neighbors_start[i].which_vertex_not[j])
+				return false;
+	const stl_stats &sa = a.stats;
+	const stl_stats &sb = b.stats;
+	return strcmp(sa.header, sb.header) == 0 && sa.type == sb.type && sa.number_of_facets == sb.number_of_facets &&
+		sa.original_num_facets == sb.original_num_facets && sa.min == sb.min && sa.max == sb.max && sa.size == sb.size &&
+		sa.bounding_diameter == sb.bounding_diameter && sa.shortest_edge == sb.shortest_edge &&
+		sa.connected_edges == sb.connected_edges && sa.connected_facets_1_edge == sb.connected_facets_1_edge &&
+		sa.connected_facets_2_edge == sb.connected_facets_2_edge && sa.connected_facets_3_edge == sb.connected_facets_3_edge &&
+		sa.degenerate_facets == sb.degenerate_facets && sa.facets_removed == sb.facets_removed;
+}
+
+SCENARIO("Memory mapped STL loading and parallel edge matching produce the same result as admesh", "[stl]") {
+	GIVEN("a binary STL with non-manifold edges, flipped and degenerate facets and negative zeros") {
+		indexed_triangle_set its = its_make_sphere(10., 2. * PI / 60.);
+		// Copy of the vertices mirrored along X. The vertices on the YZ plane only differ by a negative zero from the original ones.
+		const int num_vertices = int(its.vertices.size());
+		for (int i = 0; i < num_vertices; ++ i) {
+			for (int j = 0; j < 3; ++ j)
+				if (std::abs(its.vertices[i](j)) < 1e-3f)
+					its.vertices[i](j) = 0.f;
+			const stl_vertex mirrored(- its.vertices[i].x(), its.vertices[i].y(), its.vertices[i].z());
+			its.vertices.emplace_back(mirrored);
+		}
+		// Every fifth facet is doubled, every seventh facet is doubled and flipped.
+		const size_t num_faces = its.indices.size();
+		for (size_t i = 0; i < num_faces; ++ i) {
+			const stl_triangle_vertex_indices face = its.indices[i];
+			if (i % 5 == 0)
+				its.indices.emplace_back(face);
+			if (i % 7 == 0)
+				its.indices.emplace_back(face(0), face(2), face(1));
+		}
+		// Add the mirrored sphere, it touches the original sphere at the YZ plane.
+		for (size_t i = 0; i < num_faces; ++ i) {
+			const stl_triangle_vertex_indices face = its.indices[i];
+			its.indices.emplace_back(face(0) + num_vertices, face(2) + num_vertices, face(1) + num_vertices);
+		}
+		its.indices.emplace_back(0, 0, 1);
+		boost::filesystem::path temp = boost::filesystem::unique_path();
+		REQUIRE(its_write_stl_binary(temp.string().c_str(), "test", its));
+		WHEN("STL file is read and its facets are connected") {
+			stl_file stl_admesh, stl_mapped;
+			bool     admesh_ok = stl_open(&stl_admesh, temp.string().c_str());
+			bool     mapped_ok = stl_open_mapped(&stl_mapped, temp.string().c_str());
+			boost::nowide::remove(temp.string().c_str());
+			THEN("the loaded facets and statistics match") {
+				REQUIRE(admesh_ok);
+				REQUIRE(mapped_ok);
+				REQUIRE(stl_equal(stl_admesh, stl_mapped));
+			}
+			THEN("the neighbors and statistics match") {
+				stl_check_facets_exact(&stl_admesh);
+				stl_check_facets_exact_parallel(&stl_mapped);
+				REQUIRE(stl_admesh.stats.degenerate_facets == 1);
+				REQUIRE(stl_admesh.stats.connected_facets_3_edge > 0);
+				REQUIRE(stl_equal(stl_admesh, stl_mapped));
+			}
+		}
+	}
+	GIVEN("an ASCII STL") {
+		WHEN("STL file is read") {
+			stl_file stl_admesh, stl_mapped;
+			THEN("memory mapped loading falls back to admesh") {
+				REQUIRE(stl_open(&stl_admesh, stl_path("ASCII/20mmbox-LF.stl").c_str()));
+				REQUIRE(stl_open_mapped(&stl_mapped, stl_path("ASCII/20mmbox-LF.stl").c_str()));
+				REQUIRE(stl_equal(stl_admesh, stl_mapped));
+			}
+		}
+	}
+}
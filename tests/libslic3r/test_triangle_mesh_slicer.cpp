@@ -0,0 +1,51 @@
+///|/ Copyright (c) Prusa Research 2026
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include "libslic3r/Geometry.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+
+using namespace Slic3r;
+
+// Slicing a single plane never goes through the batch kernel slicing a facet with a run of slices,
+// thus slicing the planes one by one verifies the batch kernel against the scalar slice_facet().
+static void check_batch_kernel_bit_exact(const indexed_triangle_set &its, const Transform3d &trafo)
+{
+    MeshSlicingParams params;
+    params.trafo = trafo;
+
+    // Slicing planes at multiples of 1/8mm, some of them hitting the vertices of axis aligned meshes exactly.
+    const BoundingBoxf3 bbox = bounding_box(its, trafo.cast<float>());
+    std::vector<float>  zs;
+    for (int i = int(std::floor(bbox.min.z() * 8.)) - 1; i <= int(std::ceil(bbox.max.z() * 8.)) + 1; ++ i)
+        zs.emplace_back(float(i) / 8.f);
+
+    std::vector<Polygons> slices = slice_mesh(its, zs, params);
+    REQUIRE(slices.size() == zs.size());
+    for (size_t i = 0; i < zs.size(); ++ i)
+        REQUIRE(slice_mesh(its, std::vector<float>{ zs[i] }, params).front() == slices[i]);
+}
+
+TEST_CASE("Slicing a facet with a run of slices matches slicing the slices one by one", "[TriangleMeshSlicer]") {
+    const Transform3d trafo = Geometry::assemble_transform(Vec3d(1.3, -2.1, 0.7), Vec3d(0.3, -0.2, 0.9));
+    SECTION("Cylinder") {
+        check_batch_kernel_bit_exact(its_make_cylinder(10., 30., 2. * PI / 40.), trafo);
+    }
+    SECTION("Cone") {
+        check_batch_kernel_bit_exact(its_make_cone(10., 30., 2. * PI / 40.), trafo);
+    }
+    SECTION("Sphere") {
+        check_batch_kernel_bit_exact(its_make_sphere(10., 2. * PI / 40.), trafo);
+    }
+    SECTION("Bridge") {
+        check_batch_kernel_bit_exact(load_model("bridge.obj").its, trafo);
+    }
+    SECTION("Upright cylinder") {
+        // Vertices exactly on the slicing planes are sliced by the scalar path.
+        check_batch_kernel_bit_exact(its_make_cylinder(10., 5., 2. * PI / 40.), Geometry::assemble_transform(Vec3d(0.5, 0.25, 0.)));
+    }
+}
@@ -3,7 +3,11 @@
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/Format/OBJ.hpp>
+#include <oneapi/tbb/global_control.h>
+#include <initializer_list>
 #include <random>
+#include <string>
+#include <vector>
 
 #if defined(WIN32) || defined(_WIN32)
 #define PATH_SEPARATOR R"(\)"
@@ -19,6 +23,36 @@ inline Slic3r::TriangleMesh load_model(const std::string &obj_filename)
     return mesh;
 }
 
+// Models of TEST_DATA_DIR sliced by the benchmarks, from a simple cube to organic shapes with many triangles.
+inline const std::vector<std::string> benchmark_models { "20mm_cube.obj", "bridge.obj", "extruder_idler.obj", "frog_legs.obj", "ipadstand.obj", "pyramid.obj" };
+
+// Z coordinates of the middles of layers of layer_height spanning the mesh.
+inline std::vector<float> slicing_grid(const indexed_triangle_set &its, float layer_height)
+{
+    const Slic3r::BoundingBoxf3 bbox = Slic3r::bounding_box(its);
+    std::vector<float>          zs;
+    for (float z = float(bbox.min.z()) + 0.5f * layer_height; z < float(bbox.max.z()); z += layer_height)
+        zs.emplace_back(z);
+    return zs;
+}
+
+// Call fn(threads) with the parallelism of TBB limited to each of the thread counts,
+// so that a BENCHMARK called by fn measures the scaling of the parallel code.
+template<typename Fn>
+void for_each_thread_count(std::initializer_list<size_t> thread_counts, Fn &&fn)
+{
+    for (const size_t threads : thread_counts) {
+        tbb::global_control control(tbb::global_control::max_allowed_parallelism, threads);
+        fn(threads);
+    }
+}
+
+template<typename Fn>
+void for_each_thread_count(Fn &&fn)
+{
+    for_each_thread_count({ 1, 2, 4, 8, 16, 32, 64 }, std::forward<Fn>(fn));
+}
+
 template<class T>
 Slic3r::FloatingOnly<T> random_value(T minv, T maxv)
 {